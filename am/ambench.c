@@ -0,0 +1,176 @@
+/*
+ * ambench: build B+ trees over the amtest and fetest key sets scaled up
+ * SCALE times and print their shape.  Run it once as is and once with
+ * MINIREL_AM_COMPRESS=0 to see what key compression saves ("make stats").
+ * Each index is then range scanned with GT_OP from its middle key, once
+ * with AM_FindNextEntry and once with AM_FindNextEntries.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/types.h>
+#include "minirel.h"
+#include "pf.h"
+#include "hf.h"
+#include "am.h"
+
+#define FILE1       "benchrel"
+#define SCALE       1000
+#define RECSPERPAGE 100
+#define SCANBATCH   256
+
+/*
+ * key sets: amtest inserts "entry%d" for 45 even values into STRSIZE (32)
+ * byte keys, fetest indexes student.sname, "stud%d" for 30 students in
+ * MAXSTRLEN (16) byte keys
+ */
+struct keyset {
+   int         indexNo;
+   const char  *format;
+   int         keylen;
+   int         nkeys;
+} keysets[] = {
+   { 1, "entry%d", 32, 45 * SCALE },
+   { 2, "stud%d",  16, 30 * SCALE }
+};
+
+/*
+ * GT_OP scan from key, one RECID per call (batch == FALSE) or SCANBATCH
+ * per call; returns the RECIDs seen and adds up their positions in *sum
+ */
+long scanindex(int am_fd, char *key, bool_t batch, long *sum)
+{
+   int sd, i, n;
+   long count = 0;
+   RECID recids[SCANBATCH];
+
+   if ((sd = AM_OpenIndexScan(am_fd, GT_OP, key)) < 0) {
+      AM_PrintError("Problem opening index scan");
+      exit(1);
+   }
+   *sum = 0;
+   while (1) {
+      if (batch) {
+         if ((n = AM_FindNextEntries(sd, recids, SCANBATCH)) == AME_EOF)
+            break;
+         if (n < 0) {
+            AM_PrintError("Problem finding next entries");
+            exit(1);
+         }
+      } else {
+         AMerrno = AME_OK;
+         recids[0] = AM_FindNextEntry(sd);
+         if (AMerrno == AME_EOF)
+            break;
+         if (AMerrno != AME_OK) {
+            AM_PrintError("Problem finding next entry");
+            exit(1);
+         }
+         n = 1;
+      }
+      for (i = 0; i < n; i++)
+         *sum += (long)recids[i].pagenum * RECSPERPAGE + recids[i].recnum;
+      count += n;
+   }
+   if (AM_CloseIndexScan(sd) != AME_OK) {
+      AM_PrintError("Problem closing index scan");
+      exit(1);
+   }
+   return count;
+}
+
+/* build one index in random key order and print its shape */
+void buildindex(struct keyset *ks)
+{
+   int i, j, tmp, am_fd;
+   int *order;
+   long count, sum, bcount, bsum;
+   clock_t start, one, batch;
+   char key[64];
+   RECID recid;
+   AMstat stat;
+
+   if ((order = (int *)malloc(ks->nkeys * sizeof(int))) == NULL) {
+      printf("out of memory\n");
+      exit(1);
+   }
+   for (i = 0; i < ks->nkeys; i++)
+      order[i] = i;
+   srand(1);
+   for (i = ks->nkeys - 1; i > 0; i--) {
+      j = rand() % (i + 1);
+      tmp = order[i]; order[i] = order[j]; order[j] = tmp;
+   }
+
+   if (AM_CreateIndex(FILE1, ks->indexNo, STRING_TYPE, ks->keylen, FALSE)
+	!= AME_OK) {
+      AM_PrintError("Problem creating");
+      exit(1);
+   }
+   if ((am_fd = AM_OpenIndex(FILE1, ks->indexNo)) < 0) {
+      AM_PrintError("Problem opening");
+      exit(1);
+   }
+
+   for (i = 0; i < ks->nkeys; i++) {
+      /* keys are NUL padded as in amtest */
+      memset(key, '\0', sizeof(key));
+      sprintf(key, ks->format, order[i]);
+      /* the RECIDs are made up, no heap file is needed */
+      recid.pagenum = order[i] / RECSPERPAGE;
+      recid.recnum = order[i] % RECSPERPAGE;
+      if (AM_InsertEntry(am_fd, key, recid) != AME_OK) {
+         AM_PrintError("Problem Inserting rec");
+         exit(1);
+      }
+   }
+
+   if (AM_IndexStats(am_fd, &stat) != AME_OK) {
+      AM_PrintError("Problem getting index stats");
+      exit(1);
+   }
+   printf("%-8s %7d keys of %2d bytes: height %d, %5d leaves, "
+	"%4d inner pages, %8ld bytes, leaves %3d%% full\n",
+	ks->format, ks->nkeys, ks->keylen, stat.height, stat.nleaves,
+	stat.ninner, stat.nbytes, stat.leaffill);
+
+   memset(key, '\0', sizeof(key));
+   sprintf(key, ks->format, ks->nkeys / 2);
+   start = clock();
+   count = scanindex(am_fd, key, FALSE, &sum);
+   one = clock() - start;
+   start = clock();
+   bcount = scanindex(am_fd, key, TRUE, &bsum);
+   batch = clock() - start;
+   printf("%-8s range scan: %ld entries in %.3fs, batched %ld in %.3fs%s\n",
+	ks->format, count, (double)one / CLOCKS_PER_SEC,
+	bcount, (double)batch / CLOCKS_PER_SEC,
+	(count == bcount && sum == bsum) ? "" : " MISMATCH");
+
+   if (AM_CloseIndex(am_fd) != AME_OK) {
+      AM_PrintError("Problem Closing");
+      exit(1);
+   }
+   if (AM_DestroyIndex(FILE1, ks->indexNo) != AME_OK) {
+      AM_PrintError("Problem destroying");
+      exit(1);
+   }
+   free(order);
+}
+
+int main()
+{
+   int i;
+   char *compress;
+
+   AM_Init(); /* Initializes also the HF_Init */
+
+   compress = getenv(AM_COMPRESS_ENV);
+   printf("key compression %s\n",
+	(compress != NULL && strcmp(compress, "0") == 0) ? "off" : "on");
+   for (i = 0; i < sizeof(keysets) / sizeof(keysets[0]); i++)
+      buildindex(&keysets[i]);
+   return 0;
+}
@@ -0,0 +1,350 @@
+/****************************************************************************
+ * amsearch.c: intra-node key search for the AM layer
+ ****************************************************************************/
+
+#include <string.h>
+#include "minirel.h"
+#include "am.h"
+#include "amsearch.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define AM_HAVE_AVX2
+#endif
+
+bool_t AMsearchNoSIMD = FALSE;
+
+/*
+ * Branchless binary search: shrink [base, base+n) to at most
+ * AM_SEARCH_BLOCK keys that still contain the answer, i.e. every key
+ * before base is below value (or equal, for upper) and every key from
+ * base+n on is not.
+ */
+static int narrowint(const int *k, int *n, int v, int upper)
+{
+    int base = 0, half, b;
+
+    while (*n > AM_SEARCH_BLOCK) {
+	half = *n / 2;
+	b = base + half;
+	base += half * ((k[b] < v) | (upper & (k[b] == v)));
+	*n -= half;
+    }
+    return base;
+}
+
+static int narrowreal(const float *k, int *n, float v, int upper)
+{
+    int base = 0, half, b;
+
+    while (*n > AM_SEARCH_BLOCK) {
+	half = *n / 2;
+	b = base + half;
+	base += half * ((k[b] < v) | (upper & (k[b] == v)));
+	*n -= half;
+    }
+    return base;
+}
+
+/*
+ * scalar block counts: keys below value (or equal, for upper)
+ */
+static int countint(const int *k, int n, int v, int upper)
+{
+    int i, cnt = 0;
+
+    for (i = 0; i < n; i++)
+	cnt += (k[i] < v) | (upper & (k[i] == v));
+    return cnt;
+}
+
+static int countreal(const float *k, int n, float v, int upper)
+{
+    int i, cnt = 0;
+
+    for (i = 0; i < n; i++)
+	cnt += (k[i] < v) | (upper & (k[i] == v));
+    return cnt;
+}
+
+#ifdef AM_HAVE_AVX2
+/*
+ * AVX2 block counts: 8 keys per compare, counted from the movemask
+ */
+__attribute__((target("avx2,popcnt")))
+static int countint_avx2(const int *k, int n, int v, int upper)
+{
+    __m256i vv = _mm256_set1_epi32(v);
+    __m256i kk, gt;
+    int i, cnt = 0;
+
+    for (i = 0; i + 8 <= n; i += 8) {
+	kk = _mm256_loadu_si256((const __m256i *)(k + i));
+	/* lower: count k < v; upper: count k <= v, i.e. 8 - count k > v */
+	gt = upper ? _mm256_cmpgt_epi32(kk, vv) : _mm256_cmpgt_epi32(vv, kk);
+	cnt += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(gt)));
+    }
+    if (upper)
+	cnt = i - cnt;
+    return cnt + countint(k + i, n - i, v, upper);
+}
+
+__attribute__((target("avx2,popcnt")))
+static int countreal_avx2(const float *k, int n, float v, int upper)
+{
+    __m256 vv = _mm256_set1_ps(v);
+    __m256 kk;
+    int i, cnt = 0;
+
+    for (i = 0; i + 8 <= n; i += 8) {
+	kk = _mm256_loadu_ps(k + i);
+	if (upper)
+	    cnt += __builtin_popcount(_mm256_movemask_ps(
+			_mm256_cmp_ps(kk, vv, _CMP_LE_OQ)));
+	else
+	    cnt += __builtin_popcount(_mm256_movemask_ps(
+			_mm256_cmp_ps(kk, vv, _CMP_LT_OQ)));
+    }
+    return cnt + countreal(k + i, n - i, v, upper);
+}
+#endif
+
+/*
+ * the search functions handed out by AM_SetSearch
+ */
+static int lowerint(const char *keys, int nkeys, int keylen, const char *value)
+{
+    const int *k = (const int *)keys;
+    int v, base;
+
+    memcpy(&v, value, sizeof(int));
+    base = narrowint(k, &nkeys, v, 0);
+    return base + countint(k + base, nkeys, v, 0);
+}
+
+static int upperint(const char *keys, int nkeys, int keylen, const char *value)
+{
+    const int *k = (const int *)keys;
+    int v, base;
+
+    memcpy(&v, value, sizeof(int));
+    base = narrowint(k, &nkeys, v, 1);
+    return base + countint(k + base, nkeys, v, 1);
+}
+
+static int lowerreal(const char *keys, int nkeys, int keylen, const char *value)
+{
+    const float *k = (const float *)keys;
+    float v;
+    int base;
+
+    memcpy(&v, value, sizeof(float));
+    base = narrowreal(k, &nkeys, v, 0);
+    return base + countreal(k + base, nkeys, v, 0);
+}
+
+static int upperreal(const char *keys, int nkeys, int keylen, const char *value)
+{
+    const float *k = (const float *)keys;
+    float v;
+    int base;
+
+    memcpy(&v, value, sizeof(float));
+    base = narrowreal(k, &nkeys, v, 1);
+    return base + countreal(k + base, nkeys, v, 1);
+}
+
+#ifdef AM_HAVE_AVX2
+static int lowerint_avx2(const char *keys, int nkeys, int keylen,
+			const char *value)
+{
+    const int *k = (const int *)keys;
+    int v, base;
+
+    memcpy(&v, value, sizeof(int));
+    base = narrowint(k, &nkeys, v, 0);
+    return base + countint_avx2(k + base, nkeys, v, 0);
+}
+
+static int upperint_avx2(const char *keys, int nkeys, int keylen,
+			const char *value)
+{
+    const int *k = (const int *)keys;
+    int v, base;
+
+    memcpy(&v, value, sizeof(int));
+    base = narrowint(k, &nkeys, v, 1);
+    return base + countint_avx2(k + base, nkeys, v, 1);
+}
+
+static int lowerreal_avx2(const char *keys, int nkeys, int keylen,
+			const char *value)
+{
+    const float *k = (const float *)keys;
+    float v;
+    int base;
+
+    memcpy(&v, value, sizeof(float));
+    base = narrowreal(k, &nkeys, v, 0);
+    return base + countreal_avx2(k + base, nkeys, v, 0);
+}
+
+static int upperreal_avx2(const char *keys, int nkeys, int keylen,
+			const char *value)
+{
+    const float *k = (const float *)keys;
+    float v;
+    int base;
+
+    memcpy(&v, value, sizeof(float));
+    base = narrowreal(k, &nkeys, v, 1);
+    return base + countreal_avx2(k + base, nkeys, v, 1);
+}
+#endif
+
+static int lowerstr(const char *keys, int nkeys, int keylen, const char *value)
+{
+    int lo = 0, hi = nkeys, mid;
+
+    while (lo < hi) {
+	mid = lo + (hi - lo) / 2;
+	if (memcmp(keys + mid * keylen, value, keylen) < 0)
+	    lo = mid + 1;
+	else
+	    hi = mid;
+    }
+    return lo;
+}
+
+static int upperstr(const char *keys, int nkeys, int keylen, const char *value)
+{
+    int lo = 0, hi = nkeys, mid;
+
+    while (lo < hi) {
+	mid = lo + (hi - lo) / 2;
+	if (memcmp(keys + mid * keylen, value, keylen) <= 0)
+	    lo = mid + 1;
+	else
+	    hi = mid;
+    }
+    return lo;
+}
+
+/*
+ * compare key slot of a compressed area with rest, the restlen bytes of
+ * the value after the node prefix
+ */
+static int cmpsuffix(const char *area, int plen, int slot, const char *rest,
+		int restlen)
+{
+    const unsigned char *suffix;
+    unsigned short off;
+    int len, c, i;
+
+    memcpy(&off, AM_CSLOTS(area, plen) + slot * sizeof(unsigned short),
+	   sizeof(unsigned short));
+    suffix = (const unsigned char *)area + off;
+    len = (*suffix < restlen) ? *suffix : restlen;
+    if ((c = memcmp(suffix + 1, rest, len)) != 0)
+	return c;
+    /* the key is NUL padded past its suffix */
+    for (i = len; i < restlen; i++)
+	if (rest[i] != '\0')
+	    return -1;
+    return 0;
+}
+
+static int lowercstr(const char *area, int nkeys, int keylen,
+		const char *value)
+{
+    unsigned short plen;
+    int lo = 0, hi = nkeys, mid, c;
+
+    memcpy(&plen, area, sizeof(unsigned short));
+    /* all keys share the prefix, so it alone may settle the search */
+    if ((c = memcmp(AM_CPREFIX(area), value, plen)) != 0)
+	return (c > 0) ? 0 : nkeys;
+    while (lo < hi) {
+	mid = lo + (hi - lo) / 2;
+	if (cmpsuffix(area, plen, mid, value + plen, keylen - plen) < 0)
+	    lo = mid + 1;
+	else
+	    hi = mid;
+    }
+    return lo;
+}
+
+static int uppercstr(const char *area, int nkeys, int keylen,
+		const char *value)
+{
+    unsigned short plen;
+    int lo = 0, hi = nkeys, mid, c;
+
+    memcpy(&plen, area, sizeof(unsigned short));
+    if ((c = memcmp(AM_CPREFIX(area), value, plen)) != 0)
+	return (c > 0) ? 0 : nkeys;
+    while (lo < hi) {
+	mid = lo + (hi - lo) / 2;
+	if (cmpsuffix(area, plen, mid, value + plen, keylen - plen) <= 0)
+	    lo = mid + 1;
+	else
+	    hi = mid;
+    }
+    return lo;
+}
+
+bool_t AM_SearchSIMD(void)
+{
+#ifdef AM_HAVE_AVX2
+    if (!AMsearchNoSIMD && __builtin_cpu_supports("avx2")
+	&& __builtin_cpu_supports("popcnt"))
+	return TRUE;
+#endif
+    return FALSE;
+}
+
+/*
+ * pick the search functions for an index on (attrType, attrLength), from
+ * the compression flag in its header for STRING_TYPE
+ */
+int AM_SetSearch(AMsearch *search, char attrType, int attrLength,
+		bool_t compressed)
+{
+    bool_t simd = AM_SearchSIMD();
+
+    switch (attrType) {
+    case INT_TYPE:
+	if (attrLength != sizeof(int))
+	    return AME_INVALIDATTRLENGTH;
+	search->lower = lowerint;
+	search->upper = upperint;
+#ifdef AM_HAVE_AVX2
+	if (simd) {
+	    search->lower = lowerint_avx2;
+	    search->upper = upperint_avx2;
+	}
+#endif
+	break;
+    case REAL_TYPE:
+	if (attrLength != sizeof(float))
+	    return AME_INVALIDATTRLENGTH;
+	search->lower = lowerreal;
+	search->upper = upperreal;
+#ifdef AM_HAVE_AVX2
+	if (simd) {
+	    search->lower = lowerreal_avx2;
+	    search->upper = upperreal_avx2;
+	}
+#endif
+	break;
+    case STRING_TYPE:
+	if (attrLength <= 0)
+	    return AME_INVALIDATTRLENGTH;
+	search->lower = compressed ? lowercstr : lowerstr;
+	search->upper = compressed ? uppercstr : upperstr;
+	break;
+    default:
+	return AME_INVALIDATTRTYPE;
+    }
+    return AME_OK;
+}
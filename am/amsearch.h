@@ -0,0 +1,59 @@
+#ifndef __AMSEARCH_H__
+#define __AMSEARCH_H__
+
+/****************************************************************************
+ * amsearch.h: intra-node key search for the AM layer (internal)
+ *
+ * B+-tree nodes keep their keys in one contiguous, sorted array, apart
+ * from the child pointers or RECIDs, so a node can be searched without
+ * touching anything but keys.  The search functions for an index are
+ * picked once, at AM_OpenIndex time, from its attribute type and length:
+ * INT_TYPE and REAL_TYPE keys get a branchless binary search that narrows
+ * the array to AM_SEARCH_BLOCK keys and then counts the block with AVX2
+ * compares and movemask (a scalar loop without AVX2); STRING_TYPE keys
+ * get a memcmp binary search.  STRING_TYPE indexes created with key
+ * compression (the default, see am.h) keep a compressed key area instead
+ * of the plain array, and get a search that compares the node prefix
+ * once and then binary-searches the slot array.
+ ****************************************************************************/
+
+#define AM_SEARCH_BLOCK	16	/* keys counted at the end of a search */
+
+/*
+ * key area of a compressed STRING_TYPE node, whose counts and offsets are
+ * unsigned shorts so that they reach across a MAX_PAGE_SIZE page:
+ *   ushort	prefix length P
+ *   char	prefix[P], common to all keys of the node
+ *   ushort	slot[nkeys], offset of each key's suffix from the area start
+ * and at each slot offset a suffix: one length byte L, then L bytes.
+ * Key i is the prefix followed by suffix i, NUL padded to the attribute
+ * length, so trailing NULs (and the tails that inner-node separators
+ * drop) are not stored.  The ushorts need not be aligned.
+ */
+#define AM_CPREFIX(area)	((area) + sizeof(unsigned short))
+#define AM_CSLOTS(area, plen)	((area) + sizeof(unsigned short) + (plen))
+
+/*
+ * position of the first key in keys[0..nkeys-1] that is >= value (lower)
+ * or > value (upper); nkeys when there is none.  keys is the plain key
+ * array or, for a compressed index, the compressed key area.
+ */
+typedef int (*AMsearchfn)(const char *keys, int nkeys, int keylen,
+			const char *value);
+
+typedef struct {
+    AMsearchfn	lower;		/* first key >= value */
+    AMsearchfn	upper;		/* first key > value */
+} AMsearch;
+
+int  AM_SetSearch	(AMsearch *search, char attrType, int attrLength,
+			bool_t compressed);
+
+/*
+ * TRUE to use the scalar kernels even where AVX2 is available;
+ * AM_SearchSIMD tells whether AM_SetSearch hands out the AVX2 ones
+ */
+extern bool_t AMsearchNoSIMD;
+bool_t AM_SearchSIMD	(void);
+
+#endif
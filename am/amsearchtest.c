@@ -0,0 +1,233 @@
+/*
+ * amsearchtest: check the intra-node search functions of every key type,
+ * with and without SIMD, and of compressed string nodes, against a linear
+ * search on random sorted nodes of all sizes up to MAXKEYS, duplicates
+ * included.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "minirel.h"
+#include "am.h"
+#include "amsearch.h"
+
+#define MAXKEYS     1024
+#define PROBES      20
+#define STRSIZE     8
+
+static int   intkeys[MAXKEYS];
+static float realkeys[MAXKEYS];
+static char  strkeys[MAXKEYS * STRSIZE];
+static char  *area;		/* MAX_PAGE_SIZE bytes, on the heap */
+
+/* qsort comparators */
+int cmpint(const void *a, const void *b)
+{
+   return (*(const int *)a > *(const int *)b) - (*(const int *)a < *(const int *)b);
+}
+
+int cmpreal(const void *a, const void *b)
+{
+   return (*(const float *)a > *(const float *)b) - (*(const float *)a < *(const float *)b);
+}
+
+int cmpstr(const void *a, const void *b)
+{
+   return memcmp(a, b, STRSIZE);
+}
+
+/* linear reference: first key >= value (or > value, for upper) */
+int linear(const char *keys, int nkeys, int keylen, const char *value,
+	char attrType, int upper)
+{
+   int i, c;
+
+   for (i = 0; i < nkeys; i++) {
+      if (attrType == INT_TYPE)
+         c = cmpint(keys + i * keylen, value);
+      else if (attrType == REAL_TYPE)
+         c = cmpreal(keys + i * keylen, value);
+      else
+         c = cmpstr(keys + i * keylen, value);
+      if (upper ? c > 0 : c >= 0)
+         break;
+   }
+   return i;
+}
+
+/* run all node sizes for one key type and report the mismatches */
+void testtype(const char *name, char attrType, int keylen, bool_t nosimd)
+{
+   AMsearch search;
+   char *keys;
+   char value[16];
+   int n, i, p, range, wrong = 0, searches = 0;
+   int ival;
+   float rval;
+
+   AMsearchNoSIMD = nosimd;
+   if (!nosimd && !AM_SearchSIMD()) {
+      printf("%-6s simd  : no AVX2 on this CPU, skipped\n", name);
+      return;
+   }
+   if (AM_SetSearch(&search, attrType, keylen, FALSE) != AME_OK) {
+      printf("AM_SetSearch failed for %s\n", name);
+      exit(1);
+   }
+
+   keys = (attrType == INT_TYPE) ? (char *)intkeys :
+          (attrType == REAL_TYPE) ? (char *)realkeys : strkeys;
+
+   for (n = 0; n <= MAXKEYS; n += (n < 64) ? 1 : 37) {
+      /* small value range so that nodes hold duplicates */
+      range = n / 2 + 1;
+      for (i = 0; i < n; i++) {
+         intkeys[i] = rand() % range - range / 2;
+         realkeys[i] = (float)(rand() % range) / 4;
+         sprintf(value, "k%05d", rand() % range);
+         memcpy(strkeys + i * STRSIZE, value, STRSIZE);
+      }
+      qsort(intkeys, n, sizeof(int), cmpint);
+      qsort(realkeys, n, sizeof(float), cmpreal);
+      qsort(strkeys, n, STRSIZE, cmpstr);
+
+      for (p = 0; p < PROBES; p++) {
+         /* probes fall below, inside and above the keys */
+         memset(value, '\0', sizeof(value));
+         if (attrType == INT_TYPE) {
+            ival = rand() % (range + 4) - range / 2 - 2;
+            memcpy(value, &ival, sizeof(int));
+         } else if (attrType == REAL_TYPE) {
+            rval = (float)(rand() % (range + 4) - 2) / 4;
+            memcpy(value, &rval, sizeof(float));
+         } else
+            sprintf(value, "k%05d", rand() % (range + 2));
+
+         if ((*search.lower)(keys, n, keylen, value)
+		!= linear(keys, n, keylen, value, attrType, 0))
+            wrong++;
+         if ((*search.upper)(keys, n, keylen, value)
+		!= linear(keys, n, keylen, value, attrType, 1))
+            wrong++;
+         searches += 2;
+      }
+   }
+   printf("%-6s %-6s: %d searches, %d wrong\n",
+	name, nosimd ? "scalar" : "simd", searches, wrong);
+}
+
+/*
+ * build the compressed key area of strkeys[0..n-1] (see amsearch.h):
+ * the prefix common to all keys, then the slots, then the suffixes
+ * without their trailing NULs, from offset start if it is past the slots
+ */
+void compress(int n, int start)
+{
+   unsigned short plen, off;
+   int i, len;
+
+   plen = 0;
+   if (n > 0)
+      while (plen < STRSIZE
+             && strkeys[plen] == strkeys[(n - 1) * STRSIZE + plen])
+         plen++;
+   memcpy(area, &plen, sizeof(unsigned short));
+   memcpy(AM_CPREFIX(area), strkeys, plen);
+   off = AM_CSLOTS(area, plen) + n * sizeof(unsigned short) - area;
+   if (start > off)
+      off = start;
+   for (i = 0; i < n; i++) {
+      for (len = STRSIZE - plen;
+           len > 0 && strkeys[i * STRSIZE + plen + len - 1] == '\0'; len--)
+         ;
+      memcpy(AM_CSLOTS(area, plen) + i * sizeof(unsigned short), &off,
+             sizeof(unsigned short));
+      area[off] = len;
+      memcpy(area + off + 1, strkeys + i * STRSIZE + plen, len);
+      off += 1 + len;
+   }
+}
+
+/* random string of up to 5 letters after "ab", NUL padded */
+void randstr(char *buf, int range)
+{
+   int i, len = rand() % 6;
+
+   memset(buf, '\0', STRSIZE);
+   buf[0] = 'a';
+   buf[1] = 'b';
+   for (i = 0; i < len; i++)
+      buf[2 + i] = 'a' + rand() % range;
+}
+
+/*
+ * compressed string nodes, their keys sharing at least "ab", with the
+ * suffixes from offset start on
+ */
+void testcompressed(const char *name, int start)
+{
+   AMsearch search;
+   char value[STRSIZE];
+   int n, i, p, wrong = 0, searches = 0;
+
+   if (AM_SetSearch(&search, STRING_TYPE, STRSIZE, TRUE) != AME_OK) {
+      printf("AM_SetSearch failed for compressed strings\n");
+      exit(1);
+   }
+
+   for (n = 0; n <= MAXKEYS; n += (n < 64) ? 1 : 37) {
+      /* a small alphabet for small nodes, so that they share more */
+      for (i = 0; i < n; i++)
+         randstr(strkeys + i * STRSIZE, n < 16 ? 2 : 4);
+      qsort(strkeys, n, STRSIZE, cmpstr);
+      compress(n, start);
+
+      for (p = 0; p < PROBES; p++) {
+         /* probes share the prefix, or fall below or above all keys */
+         randstr(value, 5);
+         if (p % 5 == 0)
+            value[1] = (p % 10 == 0) ? 'a' : 'c';
+         if (p % 7 == 0 && n > 0)
+            memcpy(value, strkeys + (rand() % n) * STRSIZE, STRSIZE);
+
+         if ((*search.lower)(area, n, STRSIZE, value)
+		!= linear(strkeys, n, STRSIZE, value, STRING_TYPE, 0))
+            wrong++;
+         if ((*search.upper)(area, n, STRSIZE, value)
+		!= linear(strkeys, n, STRSIZE, value, STRING_TYPE, 1))
+            wrong++;
+         searches += 2;
+      }
+   }
+   printf("%-6s %-6s: %d searches, %d wrong\n", "string", name,
+	searches, wrong);
+}
+
+int main()
+{
+   AMsearch search;
+
+   srand(1);
+   testtype("int", INT_TYPE, sizeof(int), TRUE);
+   testtype("int", INT_TYPE, sizeof(int), FALSE);
+   testtype("real", REAL_TYPE, sizeof(float), TRUE);
+   testtype("real", REAL_TYPE, sizeof(float), FALSE);
+   testtype("string", STRING_TYPE, STRSIZE, TRUE);
+   /* suffix offsets above 32767 must not read back negative */
+   if ((area = malloc(MAX_PAGE_SIZE)) == NULL) {
+      printf("out of memory\n");
+      exit(1);
+   }
+   testcompressed("compr.", 0);
+   testcompressed("compr. past 32K", 40000);
+   free(area);
+
+   printf("bad int length: %s\n",
+	AM_SetSearch(&search, INT_TYPE, 2, FALSE) == AME_INVALIDATTRLENGTH ?
+	"rejected" : "accepted");
+   printf("bad type: %s\n",
+	AM_SetSearch(&search, 'x', 4, FALSE) == AME_INVALIDATTRTYPE ?
+	"rejected" : "accepted");
+   return 0;
+}
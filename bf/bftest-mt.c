@@ -0,0 +1,181 @@
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include "minirel.h"
+#include "bf.h"
+
+#define FILE_CREATE_MASK (S_IRUSR|S_IWUSR|S_IRGRP)
+
+/*
+ * default files
+ */
+#define FILE1	"file1"
+#define FD1	10
+
+/*
+ * each thread does LOOKUPS BF_GetBuf/BF_UnpinBuf pairs on random pages of
+ * a file that fits in the pool, so the test measures lookup throughput
+ * and not I/O; the thread count doubles from 1 up to MAXTHREADS or the
+ * number of online processors, and the last run always uses that many
+ */
+#define LOOKUPS		200000
+#define MAXTHREADS	64
+
+static BFreq	breq;
+static char	header[PAGE_SIZE];
+static int	npages;
+
+/*
+ * create the file with npages pages through the buffer manager, and
+ * leave them all in the pool
+ */
+void makefile(const char *fname)
+{
+    PFpage *fpage;
+    int i, unixfd;
+
+    unlink(fname);
+    if ((unixfd = open(fname, O_RDWR|O_CREAT, FILE_CREATE_MASK))<0){
+	printf("open failed: %s",fname);
+	exit(-1);
+    }
+
+    memset(header, 0x00, PAGE_SIZE);
+    if(write(unixfd, header, PAGE_SIZE) != PAGE_SIZE) {
+	fprintf(stderr,"makefile writing header failed: %s\n",fname);
+	exit(-1);
+    }
+
+    breq.fd = FD1;
+    breq.unixfd = unixfd;
+
+    for (i=0; i < npages; i++){
+        breq.pagenum = i;
+        if (BF_AllocBuf(breq, &fpage) != BFE_OK) {
+	    BF_PrintError("alloc buffer failed");
+	    exit(-11);
+	}
+	sprintf((char*)fpage,"%4d%4d",breq.fd,breq.pagenum);
+	if (BF_TouchBuf(breq) != BFE_OK || BF_UnpinBuf(breq) != BFE_OK) {
+	    BF_PrintError("touch/unpin buffer failed");
+	    exit(-11);
+	}
+    }
+}
+
+/*
+ * body of one lookup thread; arg points to its random seed
+ */
+void *lookups(void *arg)
+{
+    unsigned int *seed = (unsigned int *)arg;
+    BFreq bq;
+    PFpage *fpage;
+    int i, fd, pagenum;
+
+    bq = breq;
+    for (i=0; i < LOOKUPS; i++) {
+	/* private LCG: rand() is not thread-safe */
+	*seed = *seed * 1103515245 + 12345;
+	bq.pagenum = (*seed >> 16) % npages;
+	if (BF_GetBuf(bq, &fpage) != BFE_OK) {
+	    printf("BF_GetBuf failed (pagenum=%d)\n",bq.pagenum);
+	    exit(-1);
+	}
+	sscanf((char*)fpage,"%4d%4d",&fd,&pagenum);
+	if (pagenum != bq.pagenum) {
+	    printf("wrong page: wanted %d, got %d\n",bq.pagenum,pagenum);
+	    exit(-1);
+	}
+	if (BF_UnpinBuf(bq) != BFE_OK) {
+	    printf("BF_UnpinBuf failed (pagenum=%d)\n",bq.pagenum);
+	    exit(-11);
+	}
+    }
+    return NULL;
+}
+
+/*
+ * run nthreads lookup threads and return the elapsed time in seconds
+ */
+double runthreads(int nthreads)
+{
+    pthread_t tid[MAXTHREADS];
+    unsigned int seed[MAXTHREADS];
+    struct timeval start, end;
+    int i;
+
+    gettimeofday(&start, NULL);
+    for (i=0; i < nthreads; i++) {
+	seed[i] = i + 1;
+	if (pthread_create(&tid[i], NULL, lookups, &seed[i]) != 0) {
+	    printf("pthread_create failed (thread %d)\n",i);
+	    exit(-1);
+	}
+    }
+    for (i=0; i < nthreads; i++)
+	pthread_join(tid[i], NULL);
+    gettimeofday(&end, NULL);
+
+    return (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
+}
+
+/*
+ * measure how BF lookup throughput scales with the number of threads
+ */
+void testbf3(void)
+{
+    int nthreads, maxthreads;
+    double secs, rate, base;
+
+    maxthreads = sysconf(_SC_NPROCESSORS_ONLN);
+    if (maxthreads < 1)
+	maxthreads = 1;
+    if (maxthreads > MAXTHREADS)
+	maxthreads = MAXTHREADS;
+
+    npages = BF_NumBufs() / 2;
+    makefile(FILE1);
+
+    printf("%d buffers, %d pages, %d lookups per thread\n",
+	BF_NumBufs(), npages, LOOKUPS);
+    base = 0;
+    for (nthreads=1; nthreads <= maxthreads;
+	 nthreads = (nthreads < maxthreads && nthreads * 2 > maxthreads) ?
+		    maxthreads : nthreads * 2) {
+	secs = runthreads(nthreads);
+	rate = (double)nthreads * LOOKUPS / secs;
+	if (nthreads == 1)
+	    base = rate;
+	printf("%3d threads: %12.0f lookups/sec  speedup %5.2f\n",
+	    nthreads, rate, rate / base);
+	fflush(stdout);
+    }
+
+    if (BF_FlushBuf(breq.fd) != BFE_OK) {
+	BF_PrintError("flush buffer failed");
+	exit(-12);
+    }
+    if (close(breq.unixfd) < 0) {
+	printf("close failed : file1");
+	exit(-1);
+    }
+    unlink(FILE1);
+}
+
+int main()
+{
+  /* initialize BF layer */
+  BF_Init();
+
+  printf("\n************* Starting testbf3 *************\n");
+  testbf3();
+  printf("\n************* End testbf3 ******************\n");
+  return 0;
+}
@@ -0,0 +1,177 @@
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "minirel.h"
+#include "bf.h"
+
+#define FILE_CREATE_MASK (S_IRUSR|S_IWUSR|S_IRGRP)
+
+/*
+ * default files
+ */
+#define FILE1	"file1"
+#define FD1	10
+
+/*
+ * workload shape: the file holds SCANFACTOR times as many pages as the
+ * pool, the first quarter of the pool worth of pages is the hot set
+ * (think B+-tree root and inner pages), and every round does LOOKUPS
+ * point lookups on the hot set followed by one full sequential scan.
+ */
+#define SCANFACTOR	4
+#define ROUNDS		10
+#define LOOKUPS		200
+
+static BFreq	breq;
+static char	header[PAGE_SIZE];
+
+static const char *polname[] = { "lru", "2q", "clockpro" };
+
+/*
+ * fetch and unpin one page, exiting on any error
+ */
+void touchpage(int pagenum)
+{
+    PFpage *fpage;
+
+    breq.pagenum = pagenum;
+    if (BF_GetBuf(breq, &fpage) != BFE_OK) {
+	printf("BF_GetBuf failed (pagenum=%d)\n",pagenum);
+	BF_PrintError("getBuf failed");
+	exit(-1);
+    }
+    if (BF_UnpinBuf(breq) != BFE_OK) {
+	BF_PrintError("unpin buffer failed");
+	exit(-11);
+    }
+}
+
+/*
+ * create the file with npages pages through the buffer manager
+ */
+void makefile(const char *fname, int npages)
+{
+    PFpage *fpage;
+    int i, unixfd;
+
+    unlink(fname);
+    if ((unixfd = open(fname, O_RDWR|O_CREAT, FILE_CREATE_MASK))<0){
+	printf("open failed: %s",fname);
+	exit(-1);
+    }
+
+    memset(header, 0x00, PAGE_SIZE);
+    if(write(unixfd, header, PAGE_SIZE) != PAGE_SIZE) {
+	fprintf(stderr,"makefile writing header failed: %s\n",fname);
+	exit(-1);
+    }
+
+    breq.fd = FD1;
+    breq.unixfd = unixfd;
+
+    for (i=0; i < npages; i++){
+        breq.pagenum = i;
+        if (BF_AllocBuf(breq, &fpage) != BFE_OK) {
+	    BF_PrintError("alloc buffer failed");
+	    exit(-11);
+	}
+	sprintf((char*)fpage,"%4d%4d",breq.fd,breq.pagenum);
+	if (BF_TouchBuf(breq) != BFE_OK || BF_UnpinBuf(breq) != BFE_OK) {
+	    BF_PrintError("touch/unpin buffer failed");
+	    exit(-11);
+	}
+    }
+
+    if (BF_FlushBuf(breq.fd) != BFE_OK) {
+	BF_PrintError("flush buffer failed");
+	exit(-12);
+    }
+}
+
+/*
+ * run the mixed point-lookup plus sequential-scan workload under one
+ * policy and report the hit ratio of the hot lookups and of all requests
+ */
+void runpolicy(int policy, int npages, int nhot)
+{
+    BFstat before, after;
+    long hothits, hotreqs;
+    int i, j;
+
+    /* start every policy from an empty pool with the same random stream */
+    if (BF_FlushBuf(breq.fd) != BFE_OK) {
+	BF_PrintError("flush buffer failed");
+	exit(-12);
+    }
+    if (BF_SetPolicy(policy) != BFE_OK) {
+	BF_PrintError("set policy failed");
+	exit(-1);
+    }
+    BF_ResetStats();
+    srand(1);
+
+    hothits = hotreqs = 0;
+    for (i=0; i < ROUNDS; i++) {
+	BF_GetStats(&before);
+	for (j=0; j < LOOKUPS; j++)
+	    touchpage(rand() % nhot);
+	BF_GetStats(&after);
+	hothits += after.hits - before.hits;
+	hotreqs += LOOKUPS;
+
+	for (j=0; j < npages; j++)
+	    touchpage(j);
+    }
+
+    BF_GetStats(&after);
+    printf("%-10s hot hit ratio %6.2f%%   overall hit ratio %6.2f%%\n",
+	polname[policy],
+	100.0 * hothits / hotreqs,
+	100.0 * after.hits / (after.hits + after.misses));
+    fflush(stdout);
+}
+
+/*
+ * compare the replacement policies on a scan-polluted workload
+ */
+void testbf2(void)
+{
+    int npages, nhot;
+
+    npages = SCANFACTOR * BF_NumBufs();
+    nhot = BF_NumBufs() / 4;
+
+    /* makefile leaves the file open in breq.unixfd */
+    makefile(FILE1, npages);
+
+    printf("%d buffers, %d pages, %d hot pages, %d rounds\n",
+	BF_NumBufs(), npages, nhot, ROUNDS);
+    runpolicy(BF_POLICY_LRU, npages, nhot);
+    runpolicy(BF_POLICY_2Q, npages, nhot);
+    runpolicy(BF_POLICY_CLOCKPRO, npages, nhot);
+
+    if (BF_FlushBuf(breq.fd) != BFE_OK) {
+	BF_PrintError("flush buffer failed");
+	exit(-12);
+    }
+    if (close(breq.unixfd) < 0) {
+	printf("close failed : file1");
+	exit(-1);
+    }
+    unlink(FILE1);
+}
+
+int main()
+{
+  /* initialize BF layer */
+  BF_Init();
+
+  printf("\n************* Starting testbf2 *************\n");
+  testbf2();
+  printf("\n************* End testbf2 ******************\n");
+  return 0;
+}
@@ -5,6 +5,24 @@
 
 #define AM_ITAB_SIZE    MAXOPENFILES    /* max number of AM files allowed */
 #define MAXISCANS       MAXOPENFILES    /* max number of AM scans allowed */
+#define AM_FILLFACTOR   90              /* default bulk-load fill, percent */
+#define AM_SORT_PAGES   64              /* pages of memory per sort run */
+#define AM_COMPRESS_ENV "MINIREL_AM_COMPRESS" /* "0": no key compression */
+#define AM_POSTING_INLINE 256           /* max posting bytes kept in a leaf */
+#define AM_PREFETCH_LEAVES 4            /* leaves a range scan reads ahead */
+
+/*
+ * index shape, as returned by AM_IndexStats
+ */
+typedef struct {
+    int		height;			/* levels, leaves included */
+    int		nleaves;		/* leaf pages */
+    int		ninner;			/* inner pages, root included */
+    int		noverflow;		/* posting-list overflow pages */
+    long	nentries;		/* (key, RECID) entries */
+    long	nbytes;			/* index file size */
+    int		leaffill;		/* average leaf fill, percent */
+} AMstat;
 
 
 /****************************************************************************
@@ -17,20 +35,67 @@
 void AM_Init		(void);
 int  AM_CreateIndex	(const char *fileName, int indexNo, char attrType,
 			int attrLength, bool_t isUnique);
+int  AM_CreateIndexSize	(const char *fileName, int indexNo, char attrType,
+			int attrLength, bool_t isUnique, int pageSize);
 int  AM_DestroyIndex	(const char *fileName, int indexNo); 
 int  AM_OpenIndex       (const char *fileName, int indexNo);
 int  AM_CloseIndex      (int fileDesc);
 int  AM_InsertEntry	(int fileDesc, char *value, RECID recId);
+int  AM_BeginBulkLoad	(int fileDesc, int fillFactor);
+int  AM_BulkInsert	(int fileDesc, char *value, RECID recId);
+int  AM_EndBulkLoad	(int fileDesc);
 int  AM_DeleteEntry     (int fileDesc, char *value, RECID recId);
 int  AM_OpenIndexScan	(int fileDesc, int op, char *value);
 RECID AM_FindNextEntry	(int scanDesc);
+int  AM_FindNextEntries	(int scanDesc, RECID recIds[], int maxRecs);
 int  AM_CloseIndexScan	(int scanDesc);
+int  AM_IndexStats	(int fileDesc, AMstat *stat);
 void AM_PrintError	(const char *errString);
 
+/*
+ * STRING_TYPE indexes compress their keys unless AM_COMPRESS_ENV is "0"
+ * when the index is created; the choice is kept in the index header.
+ * A leaf stores the prefix common to all its keys once, followed by a
+ * slot array of offsets to the key suffixes, and an inner node keeps
+ * only the shortest prefix of each separator that still divides its
+ * children.  Search compares the key with the node prefix first and then
+ * binary-searches the slot array, so lookups stay O(log n) per node.
+ */
+
+/*
+ * In an index created with isUnique == FALSE each distinct key is stored
+ * once with a posting list of its RECIDs, sorted by (pagenum, recnum) and
+ * delta encoded.  A list longer than AM_POSTING_INLINE bytes moves to a
+ * chain of overflow pages, so there is no limit on RECIDs per key, and
+ * the RECIDs of one key are returned in page order.
+ */
+
+/*
+ * A scan with op other than EQ_OP walks the leaves through their sibling
+ * pointers.  Each time it enters a leaf it passes the page numbers of the
+ * next AM_PREFETCH_LEAVES leaves, taken from the child pointers of the
+ * parent node still buffered from the descent, to PF_PrefetchPages on the
+ * index file, so the leaf reads overlap the processing of the current one.
+ * AM_FindNextEntries returns the next RECIDs of the scan in recIds, up to
+ * maxRecs of them, in the order AM_FindNextEntry would; it returns how
+ * many it stored, or AME_EOF once the scan is done.  Both calls may be
+ * mixed on one scan.
+ */
+
+/*
+ * Bulk loading builds an empty index bottom-up (BuildIndex uses it).
+ * AM_BulkInsert takes the (key, RECID) pairs in any order and writes
+ * sorted runs of AM_SORT_PAGES pages to temporary files; AM_EndBulkLoad
+ * merges the runs, fills the leaves left to right to fillFactor percent
+ * (0 means AM_FILLFACTOR), builds each inner level from the first keys
+ * of the level below, and removes the runs.  While the load is open the
+ * index accepts no other operation (AME_BULKLOAD).
+ */
+
 /*
  * AM layer constants 
  */
-#define AM_NERRORS      25      /* maximun number of AM  errors */    
+#define AM_NERRORS      28      /* maximun number of AM  errors */    
 
 /*
  * AM layer error codes
@@ -61,9 +126,12 @@ void AM_PrintError	(const char *errString);
 #define         AME_INVALIDATTR         (-19)
 #define         AME_NOMEM               (-20)
 #define         AME_INVALIDRECORD       (-21)
-#define         AME_TOOMANYRECSPERKEY   (-22)
+#define         AME_TOOMANYRECSPERKEY   (-22)		/* no longer used */
 #define         AME_KEYNOTFOUND         (-23)
 #define         AME_DUPLICATEKEY        (-24)
+#define         AME_INVALIDPAGESIZE     (-25)
+#define         AME_NOTEMPTY            (-26)
+#define         AME_BULKLOAD            (-27)
 
 /*
  * global error value
@@ -6,14 +6,102 @@
  ****************************************************************************/
 
 /*
- * size of buffer pool
+ * default size of buffer pool; the actual size is chosen at BF_Init time
+ * from the BF_BUFS_ENV environment variable, or by BF_InitPool/BF_Resize
  */
 #define BF_MAX_BUFS     40
+#define BF_MIN_BUFS     4
+#define BF_BUFS_ENV     "MINIREL_BF_BUFS"
 
 /*
- * size of BF hash table
+ * default size of BF hash table; when not given explicitly (BF_HASH_ENV or
+ * BF_InitPool) the table is sized to BF_HASH_LOAD frames per bucket, so
+ * bucket chains stay short as the pool grows
  */
 #define BF_HASH_TBL_SIZE 20
+#define BF_HASH_LOAD    2
+#define BF_HASH_ENV     "MINIREL_BF_HASH"
+
+/*
+ * frame arena: the frames are carved out of one BF_FRAME_ALIGN-aligned
+ * arena, backed by BF_HUGEPAGE_SIZE huge pages when BF_HUGEPAGE_ENV is set
+ * (MAP_HUGETLB, or MADV_HUGEPAGE if no huge pages are reserved).  Frame
+ * control blocks (fd, pagenum, pin count, dirty flag) live in a separate
+ * array aligned to BF_CACHELINE.  BF_Resize grows the pool by adding arena
+ * segments, so a pinned frame never moves.  Pool sizes count PAGE_SIZE
+ * frames; a page of a larger bq.pagesize occupies pagesize/PAGE_SIZE
+ * contiguous frames, handed out by a buddy allocator over the arena.
+ */
+#define BF_FRAME_ALIGN          4096
+#define BF_CACHELINE            64
+#define BF_HUGEPAGE_SIZE        (2 * 1024 * 1024)
+#define BF_HUGEPAGE_ENV         "MINIREL_BF_HUGEPAGES"
+
+/*
+ * buffer replacement policies; the policy is chosen at BF_Init time from
+ * BF_POLICY_ENV ("lru", "2q" or "clockpro") and may be changed afterwards
+ * with BF_SetPolicy.  LRU stays the default when BF_POLICY_ENV is unset
+ * or unknown, so the replacement order seen by BF_ShowBuf (bftest.out)
+ * is unchanged.  2Q admits a page to the main LRU list only on its
+ * second reference within BF_2Q_KOUT_PCT of the pool, so one sequential
+ * scan cannot push out hot index pages.
+ */
+#define BF_POLICY_LRU           0
+#define BF_POLICY_2Q            1
+#define BF_POLICY_CLOCKPRO      2
+#define BF_POLICY_ENV           "MINIREL_BF_POLICY"
+#define BF_2Q_KIN_PCT           25      /* A1in FIFO, % of pool frames */
+#define BF_2Q_KOUT_PCT          50      /* A1out ghost list, % of pool */
+
+/*
+ * I/O back ends; the engine is chosen at BF_Init time from BF_IO_ENV
+ * ("sync", "threads" or "uring") and may be changed with BF_SetIOEngine
+ * while no I/O is outstanding.  The asynchronous engines submit misses,
+ * prefetches and write-backs in batches of up to BF_IO_BATCH requests and
+ * complete them in any order; BF_GetBuf on a page still being read waits
+ * for that read only, and BF_FlushBuf waits for the file's write-backs.
+ * BF_IO_URING falls back to BF_IO_THREADS (BF_IO_WORKERS pread/pwrite
+ * threads) when the kernel or the build (BF_HAVE_URING) lacks io_uring.
+ */
+#define BF_IO_SYNC              0
+#define BF_IO_THREADS           1
+#define BF_IO_URING             2
+#define BF_IO_ENV               "MINIREL_BF_IO"
+#define BF_IO_WORKERS           4
+#define BF_IO_BATCH             32
+
+/*
+ * background writer: a flusher thread wakes every BF_FLUSH_INTERVAL ms and,
+ * once more than BF_DIRTY_HIGH percent of the frames are dirty, writes back
+ * dirty unpinned frames until fewer than BF_DIRTY_LOW percent remain.
+ * Adjacent pages of the same file go out in one pwritev().  Thresholds come
+ * from BF_DIRTY_ENV ("low,high") or BF_SetFlusher; a high mark of 0 stops
+ * the thread, so pages are written only on eviction and BF_FlushBuf.
+ */
+#define BF_DIRTY_LOW            10
+#define BF_DIRTY_HIGH           30
+#define BF_FLUSH_INTERVAL       100
+#define BF_DIRTY_ENV            "MINIREL_BF_DIRTY"
+
+/*
+ * concurrency: BF calls may be made from several threads at once.  Each
+ * hash bucket has its own latch, pin counts are updated atomically, and
+ * the replacement state is split into BF_NPARTITIONS partitions (a page
+ * belongs to the partition of its hash bucket), each with its own latch.
+ * BF_Resize, BF_SetPolicy and BF_ShowBuf latch the whole pool.  BFerrno
+ * is shared, so threaded callers should rely on return codes.
+ */
+#define BF_NPARTITIONS          8
+
+/*
+ * buffer pool statistics, as returned by BF_GetStats
+ */
+typedef struct _buffer_statistics {
+    long        hits;                   /* BF_GetBuf found page in pool */
+    long        misses;                 /* BF_GetBuf read page from disk */
+    long        writes;                 /* dirty pages written back */
+    long        prefetches;             /* pages read by BF_PrefetchBufs */
+} BFstat;
 
 /*
  * prototypes for BF-layer functions
@@ -27,10 +115,68 @@ int BF_FlushBuf(int fd);
 void BF_ShowBuf(void);
 void BF_PrintError(const char *s);
 
+/*
+ * BF_PrefetchBufs reads up to npages pages starting at bq.pagenum into the
+ * pool without pinning them; pages already buffered are skipped and each
+ * contiguous run of missing pages costs one preadv().  It returns the
+ * number of pages read, and stops early rather than evict a pinned page.
+ */
+int BF_PrefetchBufs(BFreq bq, int npages);
+
+/*
+ * BF_Crc32c computes the CRC32C (Castagnoli) of len bytes, using the SSE4.2
+ * crc32 instruction when the CPU has it.  BF stamps each page trailer with
+ * it on write-back and checks it on every read from disk; a mismatch fails
+ * the request with BFE_CHECKSUM.  PF does the same for the file header,
+ * which it writes directly, and for the pages of PF_MODE_MMAP files,
+ * which it reads without BF (see pf.h).  A page that is all zeros was never
+ * written (e.g. preallocated) and is accepted as is.
+ */
+unsigned int BF_Crc32c(const char *buf, int len);
+
+/*
+ * BF_SetLogFlush installs the WAL hook: before a dirty page is written
+ * back, BF calls logflush with the page's PF_PAGE_LSN and fails the write
+ * unless it returns 0.  LG_Open installs LG_Flush; with no hook installed
+ * pages are written unconditionally.
+ */
+void BF_SetLogFlush(int (*logflush)(LSN lsn));
+
+/*
+ * BF_Checkpoint writes back at most maxpages (0 means all) dirty unpinned
+ * pages of file fd, or of every file if fd < 0, and keeps them buffered.
+ * It returns the number of dirty pages left, so callers can bound the
+ * work left for BF_FlushBuf at close time.
+ */
+int BF_Checkpoint(int fd, int maxpages);
+
+/*
+ * pool configuration and statistics
+ *
+ * BF_InitPool is BF_Init with explicit sizes; a size of 0 falls back to the
+ * environment variable and then to the default above.  BF_Resize grows or
+ * shrinks the pool online and rehashes the table to match.  Shrinking
+ * writes back dirty victims and never drops a pinned page: it fails with
+ * BFE_PAGEPINNED if not enough unpinned frames can be released.
+ * BF_SetPolicy keeps the buffered pages but restarts the replacement
+ * state; it returns BFE_INVALIDPOLICY for an unknown policy.
+ * BF_SetIOEngine returns the engine actually in use after any fallback,
+ * or BFE_INVALIDENGINE.  BF_SetFlusher returns BFE_INVALIDSIZE unless
+ * 0 <= lowpct <= highpct <= 100.
+ */
+int BF_InitPool(int nbufs, int hashsize);
+int BF_Resize(int nbufs);
+int BF_NumBufs(void);
+int BF_SetPolicy(int policy);
+void BF_GetStats(BFstat *stat);
+void BF_ResetStats(void);
+int BF_SetIOEngine(int engine);
+int BF_SetFlusher(int lowpct, int highpct);
+
 /******************************************************************************/
 /*      BF Layer - Error codes definition                                     */
 /******************************************************************************/
-#define BF_NERRORS              14      /* number of error codes used */
+#define BF_NERRORS              18      /* number of error codes used */
 
 #define BFE_OK                  0
 #define BFE_NOMEM               (-1)
@@ -46,6 +192,10 @@ void BF_PrintError(const char *s);
 #define BFE_MSGERR              (-11)
 #define BFE_HASHNOTFOUND        (-12)
 #define BFE_HASHPAGEEXIST       (-13)
+#define BFE_INVALIDSIZE         (-14)
+#define BFE_INVALIDPOLICY       (-15)
+#define BFE_INVALIDENGINE       (-16)
+#define BFE_CHECKSUM            (-17)
 
 /*
  * error in UNIX system call or library routine
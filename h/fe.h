@@ -17,6 +17,14 @@
 #define MAXSTRINGLEN	255
 #endif
 
+/*
+ * Select and Delete scan a relation with HF_OpenParallelScan when it has
+ * at least FE_PARALLEL_MINPAGES pages (or the value of FE_PARALLEL_ENV)
+ * and the selection is not answered through an index
+ */
+#define FE_PARALLEL_MINPAGES	64
+#define FE_PARALLEL_ENV		"MINIREL_FE_PARALLEL_MINPAGES"
+
 /*
  * ATTR_DESCR: attribute descriptor used in CreateTable
  */
@@ -45,6 +53,16 @@ typedef struct{
 } ATTR_VAL;
 
 
+/*
+ * Prototypes for database functions.  DBconnect makes the database the
+ * current directory and runs crash recovery from its log (LG_Open);
+ * DBclose flushes the buffer pool and closes the log.
+ */
+int  DBcreate(const char *dbname);
+int  DBdestroy(const char *dbname);
+int  DBconnect(const char *dbname);
+int  DBclose(const char *dbname);
+
 /*
  * Prototypes for FE layer functions
  * They start with UT because FE layer functions are 
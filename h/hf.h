@@ -5,39 +5,142 @@
 
 #define HF_FTAB_SIZE	MAXOPENFILES	/* max number of HF files allowed */
 #define MAXSCANS        MAXOPENFILES	/* max number of HF scans allowed */
+#define HF_MAXPREDS     8		/* max predicates per HF scan */
+#define HF_MORSEL_PAGES 16		/* pages per parallel scan morsel */
 
 
 /****************************************************************************
  * hf.h: external interface definition for the HF layer 
  ****************************************************************************/
 
+/*
+ * one predicate of a conjunctive scan: attribute op value
+ */
+typedef struct {
+    char	attrType;		/* INT_TYPE, REAL_TYPE or STRING_TYPE */
+    int		attrLength;		/* attribute length */
+    int		attrOffset;		/* attribute offset in the record */
+    int		op;			/* comparison operator */
+    const char	*value;			/* comparison value */
+} HFpred;
+
 /*
  * prototypes for HF-layer functions
  */
 void 	HF_Init(void);
 int 	HF_CreateFile(const char *fileName, int RecSize);
+int 	HF_CreateFileSize(const char *fileName, int RecSize, int pageSize);
+int 	HF_CreateVarFile(const char *fileName, int maxRecSize);
 int 	HF_DestroyFile(const char *fileName);
 int 	HF_OpenFile(const char *fileName);
 int	HF_CloseFile(int fileDesc);
 RECID	HF_InsertRec(int fileDesc, char *record);
+int	HF_InsertRecs(int fileDesc, char *records, int n, RECID *recIds);
+RECID	HF_InsertVarRec(int fileDesc, char *record, int recLen);
+int	HF_RecLength(int fileDesc, RECID recId);
 int 	HF_DeleteRec(int fileDesc, RECID recId);
 RECID 	HF_GetFirstRec(int fileDesc, char *record);
 RECID	HF_GetNextRec(int fileDesc, RECID recId, char *record);
 int	HF_GetThisRec(int fileDesc, RECID recId, char *record);
 int 	HF_OpenFileScan(int fileDesc, char attrType, int attrLength, 
 			int attrOffset, int op, const char *value);
+int	HF_OpenFileScanPreds(int fileDesc, int npreds, const HFpred preds[]);
+int	HF_OpenParallelScan(int fileDesc, int npreds, const HFpred preds[]);
 RECID	HF_FindNextRec(int scanDesc, char *record);
+int	HF_FindNextBatch(int scanDesc, int maxRecs, RECID recIds[],
+			const char *records[]);
+RECID 	HF_GetFirstRecView(int fileDesc, const char **record);
+RECID	HF_GetNextRecView(int fileDesc, RECID recId, const char **record);
+int	HF_GetThisRecView(int fileDesc, RECID recId, const char **record);
+RECID	HF_FindNextRecView(int scanDesc, const char **record);
+int	HF_ReleaseView(int fileDesc);
 int	HF_CloseFileScan(int scanDesc);
 void	HF_PrintError(const char *errString);
 bool_t         HF_ValidRecId(int fileDesc, RECID recid);
+int	HF_NumPages(int fileDesc);
 /*void	HF_SetErrStream(FILE *fp);*/
 
 /*int   HF_HeaderInfo(int fileDesc, HFHeader *FileInfo);*/
 
+/*
+ * HF_InsertRecs inserts n records stored back to back in records and
+ * returns their RECIDs in recIds[0..n-1], e.g. for AM index maintenance.
+ * Records fill each page with free space before moving to the next, so
+ * every target page is pinned once and its free-space bookkeeping is
+ * updated once.  It returns the number of records inserted, which is less
+ * than n only if an error (set in HFerrno) stopped the batch.
+ */
+
+/*
+ * HF_OpenFileScanPreds opens a scan returning the records that satisfy
+ * all npreds predicates (1..HF_MAXPREDS); HF_OpenFileScan is the
+ * single-predicate case.  Each predicate is checked when the scan is
+ * opened and bound to a comparison function for its type and operator
+ * (HF_BindPreds, hfpred.c), so HF_FindNextRec tests records in place on
+ * the buffered page with no per-record switch, and copies out only the
+ * records that match.
+ */
+
+/*
+ * HF_FindNextBatch returns the next matches of a scan a page at a time:
+ * up to maxRecs RECIDs in recIds and pointers to the records, in place in
+ * the pinned page, in records.  The pointers stay valid until the next
+ * call on the scan or HF_CloseFileScan.  It returns the number of matches
+ * (> 0), HFE_EOF at the end of the file, or an error code.  On fixed-size
+ * files, INT_TYPE and REAL_TYPE predicates are evaluated for the whole
+ * page at once: the attribute column is gathered from the fixed-stride
+ * records and compared with AVX2 (or SSE2) into a match bitmap, chosen at
+ * run time from the CPU, with a scalar loop as the fallback (HF_BindFilter,
+ * hfsimd.c).
+ */
+
+/*
+ * HF_OpenParallelScan opens a scan like HF_OpenFileScanPreds whose pages
+ * are searched by the TP task pool (tp.h, TP_Init must have been called):
+ * the file is cut into morsels of HF_MORSEL_PAGES pages, every worker
+ * applies the predicates to its morsels and collects the matches in its
+ * own buffer, and the buffers are merged back into page order.  The
+ * results are read with HF_FindNextRec or HF_FindNextBatch as for a
+ * serial scan, except that workers copy each match out of its page and
+ * unpin the page when the morsel is done: the records[] pointers that
+ * HF_FindNextBatch returns point at those copies in the merged buffer, not
+ * into pinned pages, and stay valid until the next call on the scan or
+ * HF_CloseFileScan, as for a serial scan.
+ * Workers call no HF function and only two PF ones, PF_GetThisPage and
+ * PF_UnpinPage, which are safe to call from several threads on one open
+ * file (see pf.h).  A worker keeps the first error code those calls
+ * return in the scan instead of reading PFerrno, and stops; HF_FindNextRec
+ * or HF_FindNextBatch then reports it, and sets HFerrno, on the thread
+ * that reads the scan.  HF_NumPages gives the file size for choosing
+ * between a serial and a parallel scan.
+ */
+
+/*
+ * The ...View functions are the zero-copy forms of HF_GetFirstRec,
+ * HF_GetNextRec, HF_GetThisRec and HF_FindNextRec: instead of copying the
+ * record they set *record to it, in place in its pinned page.  Each open
+ * file has one view and each scan has its own; the next view call on the
+ * same file (or scan) moves it and unpins the old page, and the view ends
+ * with HF_ReleaseView (file), HF_CloseFileScan (scan) or HF_CloseFile.
+ * The record must not be written through the pointer.
+ */
+
+/*
+ * Variable-length files (HF_CreateVarFile) use slotted pages: a slot
+ * directory at the front of the page gives each record's offset and
+ * length, and records are packed from the end of the page.  A deleted
+ * record frees its bytes but keeps its slot, and the page is compacted in
+ * place when an insert needs the space, so RECIDs never change.  The
+ * fetch and scan functions work on both formats and copy HF_RecLength
+ * bytes (the buffer must hold maxRecSize); HF_InsertRec stores maxRecSize
+ * bytes, and a scan predicate past the end of a record never matches.
+ * HF_InsertRecs works on fixed-size files only.
+ */
+
 /******************************************************************************/
 /*	Error codes definition			  			      */
 /******************************************************************************/
-#define	HF_NERRORS		21	/* number of error codes used */
+#define	HF_NERRORS		23	/* number of error codes used */
 
 #define HFE_OK                   0  /* HF routine successful */
 #define HFE_PF                  -1  /* error in PF layer */
@@ -64,6 +167,9 @@ bool_t         HF_ValidRecId(int fileDesc, RECID recid);
 
 #define HFE_INVALIDSTATS        -20 /* meaningful only when STATS_XXX macros
                                        are in use */
+#define HFE_PAGESIZE            -21 /* page size invalid or too small for
+                                       the record size */
+#define HFE_NPREDS              -22 /* Invalid number of scan predicates */
 
 /******************************************************************************/
 /*	Data structure definition		  			      */
@@ -81,7 +187,33 @@ typedef struct {
     int RecPage;                 /* Number of records per page */
     int NumPg;                   /* Number of pages in file */
     int NumFrPgFile;             /* Number of free pages in the file */ 
+    int FirstFrPg;               /* First page with a free slot, or -1 */
+    int VarLen;                  /* TRUE for slotted-page files, where
+                                    RecSize is the maximum record size */
 } HFHeader;
+
+/*
+ * Free-space map: the pages with at least one free slot form a doubly
+ * linked list headed by FirstFrPg, threaded through the page headers.
+ * HF_InsertRec takes the head of the list; a page leaves the list when
+ * it fills up and HF_DeleteRec puts it back at the head when it gains
+ * its first free slot, so both are O(1) no matter how large the file.
+ */
+typedef struct {
+    int NumRecs;                 /* Number of records in the page */
+    int NextFrPg;                /* Next page in the free list, or -1 */
+    int PrevFrPg;                /* Previous page in the free list, or -1 */
+    /* slot bitmap of RecPage bits follows */
+} HFPageHeader;
+
+/*
+ * slot directory entry of a slotted page; the directory follows the page
+ * header and NumRecs counts its entries, deleted ones included
+ */
+typedef struct {
+    RECNUM Offset;               /* Offset of the record in the page */
+    RECNUM Length;               /* Record length, 0 if deleted */
+} HFSlot;
 #endif
 
 
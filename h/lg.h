@@ -0,0 +1,128 @@
+#ifndef __LG_H__
+#define __LG_H__
+
+#include <minirel.h>
+
+/****************************************************************************
+ * lg.h: external interface definition for the LG (write-ahead log) layer
+ ****************************************************************************/
+
+/*
+ * The log is a single append-only file, LG_LOGNAME, in the database
+ * directory.  A log sequence number (LSN) is the byte offset of a record
+ * in that file.  HF and AM log every page change before making it and
+ * store the record's LSN in the page header (see PF_PAGE_LSN); BF calls
+ * LG_Flush up to a dirty page's LSN before writing the page back, so no
+ * change reaches disk before its log record (the WAL rule).
+ */
+#define LG_LOGNAME	"minirel.log"
+
+/*
+ * group commit: LG_Commit waits up to LG_GROUP_USEC microseconds, or until
+ * LG_GROUP_MAX commits are waiting, so that one fsync() makes a whole
+ * group of commit records durable.  LG_GROUP_ENV overrides the wait;
+ * 0 syncs every commit on its own.
+ */
+#define LG_GROUP_USEC	1000
+#define LG_GROUP_MAX	64
+#define LG_GROUP_ENV	"MINIREL_LG_GROUP_USEC"
+
+/*
+ * log record types; the HF and AM records are physiological: they name a
+ * page and describe the change within it (slot and bytes)
+ */
+#define LG_BEGIN	1	/* transaction start */
+#define LG_COMMIT	2	/* transaction commit */
+#define LG_ABORT	3	/* transaction abort */
+#define LG_END		4	/* transaction finished, undo done */
+#define LG_CLR		5	/* compensation record written by undo */
+#define LG_CHECKPOINT	6	/* fuzzy checkpoint: active txns, dirty pages */
+#define LG_FILENAME	7	/* binds a log file id to a file name */
+#define LG_PF_ALLOC	10	/* page allocated in a PF file */
+#define LG_HF_INSERT	20	/* data: record inserted into slot */
+#define LG_HF_DELETE	21	/* data: record deleted from slot */
+#define LG_AM_INSERT	30	/* data: entry inserted at slot */
+#define LG_AM_DELETE	31	/* data: entry deleted from slot */
+#define LG_AM_SPLIT	32	/* data: entries moved to the new sibling */
+#define LG_AM_MERGE	33	/* data: entries moved back from the sibling */
+#define LG_NTYPES	34
+
+/*
+ * header of every log record; len bytes of type-specific data follow
+ */
+typedef struct _log_record {
+    LSN		lsn;		/* LSN of this record */
+    LSN		prevlsn;	/* previous record of the same transaction */
+    LSN		undonext;	/* CLR only: next record to undo */
+    int		txid;		/* transaction id */
+    int		type;		/* one of the LG_ record types */
+    int		fileid;		/* file id, as bound by LG_FILENAME */
+    int		pagenum;	/* page changed */
+    int		slot;		/* slot or entry number within the page */
+    int		len;		/* length of the data that follows */
+} LGrec;
+
+/*
+ * Redo and undo of a record type are done by the layer that wrote it:
+ * PF_Init registers the handler for LG_PF_ALLOC, HF_Init and AM_Init the
+ * handlers for their types.  The handler gets the page named by the record
+ * through its own layer (the file from LG_FileName(rec->fileid)), applies
+ * (undo == FALSE) or reverts (undo == TRUE) the change unless the page LSN
+ * shows redo has nothing to do, stores rec->lsn as the page LSN, and
+ * unpins the page dirty.  LG never reads pages itself, so it sits below PF
+ * and above BF: libraries link in the order fe, am, hf, pf, lg, bf, with
+ * tp (used by hf) anywhere after hf.
+ */
+typedef int (*LGhandler)(const LGrec *rec, const char *data, bool_t undo);
+
+/*
+ * prototypes for LG-layer functions
+ *
+ * LG_Open opens (or creates) the log of the database in the current
+ * directory and runs ARIES restart recovery: analysis from the last
+ * checkpoint, redo through the handlers of every change whose LSN is
+ * newer than its page's, then undo of the transactions that never
+ * committed.  DBconnect calls it after chdir to the database, and DBclose
+ * calls LG_Close.  LG_FileName is the file bound to a log file id.
+ */
+void	LG_Init(void);
+int	LG_Open(void);
+int	LG_Close(void);
+int	LG_SetHandler(int type, LGhandler handler);
+int	LG_FileId(const char *fileName);
+const char *LG_FileName(int fileid);
+int	LG_Begin(void);
+LSN	LG_Write(int txid, int type, int fileid, int pagenum, int slot,
+		const char *data, int len);
+int	LG_Commit(int txid);
+int	LG_Abort(int txid);
+int	LG_Flush(LSN lsn);
+int	LG_Checkpoint(void);
+void	LG_PrintError(const char *errString);
+
+/******************************************************************************/
+/*	Error codes definition			  			      */
+/******************************************************************************/
+#define LG_NERRORS		9	/* number of error codes used */
+
+#define LGE_OK			0	/* LG routine successful */
+#define LGE_NOTOPEN		(-1)	/* log not open */
+#define LGE_TXID		(-2)	/* invalid or finished transaction id */
+#define LGE_TYPE		(-3)	/* invalid log record type */
+#define LGE_NOHANDLER		(-4)	/* no redo/undo handler for a type */
+#define LGE_CORRUPT		(-5)	/* damaged record in the log */
+#define LGE_TOOMANYTXNS		(-6)	/* too many active transactions */
+#define LGE_NOMEM		(-7)	/* out of memory */
+#define LGE_RECOVERY		(-8)	/* a redo or undo handler failed */
+
+/*
+ * error in UNIX system call or library routine
+ */
+#define LGE_UNIX		(-100)
+
+/*
+ * most recent LG error code
+ */
+extern int LGerrno;
+
+#endif
@@ -35,11 +35,38 @@ typedef float  real;
  */
 #define MAXOPENFILES    20      /* maximum # of files open at one time  */
 
+/*
+ * layout of every page, the PF header page included:
+ *   PF_PAGE_LSN	LSN of the last logged change to the page
+ *   PF_PAGE_NEXT	int reserved by PF (e.g. to chain free-page bitmaps)
+ *   PF_PAGE_DATA	start of the PF_PAGE_AREA(pagesize) bytes of data;
+ *			the header page keeps its PFhdr_str here
+ * The last PF_CRC_SIZE bytes hold a CRC32C of the rest of the page, stored
+ * by BF on write-back and verified when BF reads it in.
+ */
+#define PF_PAGE_LSN		0
+#define PF_PAGE_NEXT		(PF_PAGE_LSN+sizeof(LSN))
+#define PF_PAGE_DATA		(PF_PAGE_NEXT+sizeof(int))
+#define PF_CRC_SIZE		4
+
 #ifndef PAGE_SIZE
 #define PAGE_SIZE		4096
-#define PF_PAGE_SIZE            (PAGE_SIZE-sizeof(int))
+#define PF_PAGE_SIZE            (PAGE_SIZE-sizeof(int)-sizeof(LSN)-PF_CRC_SIZE)
 #endif
 
+/*
+ * PAGE_SIZE is the default page size; a file may be created with any power
+ * of two between MIN_PAGE_SIZE and MAX_PAGE_SIZE, recorded in its header
+ */
+#define MIN_PAGE_SIZE		PAGE_SIZE
+#define MAX_PAGE_SIZE		65536
+#define PF_PAGE_AREA(pgsize)	((pgsize)-sizeof(int)-sizeof(LSN)-PF_CRC_SIZE)
+
+
+/******************************************************************************/
+/*   Type definition for LSN, log sequence number (byte offset in the log).   */
+/******************************************************************************/
+typedef long LSN;
 
 /******************************************************************************/
 /*   Type definition for RECID, record identification in the HF layer.        */
@@ -51,6 +78,7 @@ typedef  struct _hf_record_identification {
 
 /******************************************************************************/
 /*   Type definition for pages of the PF layer.                               */
+/*   Pages of a file with a larger page size span pagesize bytes from here.   */
 /******************************************************************************/
 typedef struct PFpage {
     char pagebuf[PAGE_SIZE];		/* actual page data             */
@@ -64,6 +92,7 @@ typedef struct _buffer_request_control {
     int         unixfd;                 /* Unix file descriptor */
     int         pagenum;                /* Page number in the file */
     bool_t      dirty;                  /* TRUE if page is dirty */
+    int         pagesize;               /* page size; 0 means PAGE_SIZE */
 } BFreq;
 
 #endif
@@ -14,17 +14,129 @@
 /*
  * PF page size
  */
-#define PF_PAGE_SIZE	(PAGE_SIZE-sizeof(int))
+#define PF_PAGE_SIZE	(PAGE_SIZE-sizeof(int)-sizeof(LSN)-PF_CRC_SIZE)
 #endif
 
+/*
+ * PF file header, kept in the first page of every PF file.
+ * PF_AllocPage hands out pages from extents that are preallocated with
+ * fallocate(), starting at PF_EXTENT_PAGES and doubling up to
+ * PF_EXTENT_MAXPAGES as the file grows; the header is written when an
+ * extent is added and at PF_CloseFile, not on every allocation.
+ * The page size is fixed by PF_CreateFileSize (PF_CreateFile uses
+ * PAGE_SIZE); the header always occupies the first pagesize bytes, and
+ * PF_PAGE_AREA(PF_PageSize(fd)) bytes of each page are usable.
+ * The header page has the layout of any other page: PFhdr_str starts at
+ * PF_PAGE_DATA, and PF_PAGE_LSN holds the LSN of the last LG_PF_ALLOC
+ * applied to the header.  PF writes an LG_PF_ALLOC record for every page
+ * it allocates, and PF_Init registers PF's redo/undo handler for the type
+ * with LG_SetHandler; redo skips allocations the header LSN shows are
+ * already on disk.
+ * The header is written by PF itself, not through BF, so PF stamps its
+ * CRC32C trailer with BF_Crc32c on every write and checks it when
+ * PF_OpenFile reads it; a mismatch fails the open with PFE_CHECKSUM.
+ */
+#define PF_EXTENT_PAGES		16
+#define PF_EXTENT_MAXPAGES	1024
+#define PF_PAGE_LIST_END	(-1)
+
+typedef struct PFhdr_str {
+    int		pagesize;	/* page size of this file, in bytes */
+    int		numpages;	/* # of pages handed out, header excluded */
+    int		extpages;	/* # of pages preallocated on disk */
+    int		extsize;	/* size of the next extent, in pages */
+    int		nfree;		/* # of disposed pages awaiting reuse */
+    int		firstmap;	/* first free-page bitmap page or
+				   PF_PAGE_LIST_END */
+} PFhdr_str;
+
+#ifdef PF_FREEPAGES_MAINTAINED
+/*
+ * Disposed pages are recorded in free-page bitmap pages, each covering
+ * PF_MAP_PAGES(pagesize) pages and chained through the int every PF page
+ * reserves at PF_PAGE_NEXT.
+ * PF_AllocPage reuses the lowest free page found in the bitmap before
+ * taking a new one; asking for a disposed page gives PFE_PAGEFREE.
+ * Bitmap pages are created on the first dispose and are skipped by
+ * PF_GetFirstPage/PF_GetNextPage.
+ */
+#define PF_MAP_PAGES(pgsize)	(PF_PAGE_AREA(pgsize) * 8)
+
+int  PF_DisposePage	(int fd, int pagenum);
+#endif
+
+
+/*
+ * sequential read-ahead: once PF_GetNextPage has been called for
+ * PF_RA_TRIGGER consecutive pages of a file, the following pages are
+ * prefetched into the buffer pool in one read.  The window starts at
+ * PF_RA_MINPAGES and doubles each time the scan consumes it, up to
+ * PF_RA_MAXPAGES or the value of PF_RA_ENV (0 disables read-ahead).
+ * Any non-sequential access resets the window.  PF_SetReadAhead sets
+ * the cap for one open file.
+ */
+#define PF_RA_TRIGGER	2
+#define PF_RA_MINPAGES	4
+#define PF_RA_MAXPAGES	64
+#define PF_RA_ENV	"MINIREL_PF_READAHEAD"
+
+/*
+ * PF_PrefetchPages starts reading the n pages pagenums[0..n-1] of an open
+ * file into the buffer pool without pinning them, for callers that know
+ * their next pages but not as a sequential run (e.g. the leaves of an AM
+ * range scan).  It maps the page numbers past the header and hands each
+ * run of consecutive pages to BF_PrefetchBufs.  Pages already buffered,
+ * disposed or past the end of the file are skipped; it returns the number
+ * of pages read, or a PF error code.  On PF_MODE_MMAP files it advises
+ * the kernel with MADV_WILLNEED instead.
+ */
+
+/*
+ * open modes for PF_OpenFileMode; PF_OpenFile opens with PF_MODE_RDWR.
+ * PF_MODE_MMAP maps the file read-only, and PF_GetThisPage, PF_GetFirstPage
+ * and PF_GetNextPage return pointers straight into the mapping instead of
+ * BF frames; scans advise the kernel with MADV_SEQUENTIAL and MADV_WILLNEED
+ * over the read-ahead window.  Pages are still pinned and unpinned as for
+ * buffered files, and a page pointer stays valid until PF_CloseFile.
+ * Mapped pages never go through BF, so PF checks their checksums itself:
+ * it keeps one bit per page of the file and verifies a page's CRC32C
+ * trailer with BF_Crc32c the first time the page is handed out, failing
+ * the call with PFE_CHECKSUM on a mismatch.
+ * PF_AllocPage, PF_DirtyPage and a dirty PF_UnpinPage fail with
+ * PFE_READONLY, and a file cannot be open mapped and writable at once.
+ *
+ * PF_MODE_DIRECT opens the file with O_DIRECT so pages are cached only in
+ * the buffer pool.  All I/O, the header included, uses BF_FRAME_ALIGN
+ * aligned buffers at page-aligned offsets, which PF_CreateFile guarantees
+ * for every file.  If the filesystem rejects O_DIRECT the file is opened
+ * buffered instead; PF_FileMode returns the mode actually in effect.
+ * PF_OpenFile uses PF_MODE_DIRECT when PF_DIRECT_ENV is set.
+ */
+#define PF_MODE_RDWR	0
+#define PF_MODE_MMAP	1
+#define PF_MODE_DIRECT	2
+#define PF_DIRECT_ENV	"MINIREL_PF_DIRECT"
+
+/*
+ * PF_GetThisPage and PF_UnpinPage may be called by several threads at
+ * once on the same open file (the workers of an HF parallel scan): each
+ * open file has a latch, held while a call uses the file's table entry
+ * and while it sets PFerrno, and PF_GetThisPage does not touch the
+ * read-ahead window.  Every other PF call, and opening or closing files,
+ * is for one thread at a time.
+ */
 
 /*
  * prototypes for PF-layer functions
  */
 void PF_Init		(void);
 int  PF_CreateFile	(const char *filename);
+int  PF_CreateFileSize	(const char *filename, int pagesize);
+int  PF_PageSize	(int fd);
 int  PF_DestroyFile	(const char *filename);
 int  PF_OpenFile	(const char *filename);
+int  PF_OpenFileMode	(const char *filename, int mode);
+int  PF_FileMode	(int fd);
 int  PF_CloseFile	(int fd);
 int  PF_AllocPage	(int fd, int *pagenum, char **pagebuf);
 int  PF_GetFirstPage	(int fd, int *pagenum, char **pagebuf);
@@ -32,12 +144,14 @@ int  PF_GetNextPage	(int fd, int *pagenum, char **pagebuf);
 int  PF_GetThisPage	(int fd, int pagenum, char **pagebuf);
 int  PF_DirtyPage	(int fd, int pagenum);
 int  PF_UnpinPage	(int fd, int pagenum, int dirty);
+int  PF_SetReadAhead	(int fd, int maxpages);
+int  PF_PrefetchPages	(int fd, const int pagenums[], int n);
 void PF_PrintError	(const char *s);
 
 /******************************************************************************/
 /*      PF Layer - Error codes definition                                     */
 /******************************************************************************/
-#define PF_NERRORS              12      /* number of error codes used */
+#define PF_NERRORS              15      /* number of error codes used */
 
 #define PFE_OK			0
 #define PFE_INVALIDPAGE		(-1)
@@ -51,6 +165,9 @@ void PF_PrintError	(const char *s);
 #define PFE_PAGEFREE		(-9)
 #define PFE_NOUSERS		(-10)
 #define PFE_MSGERR              (-11)
+#define PFE_READONLY		(-12)
+#define PFE_PAGESIZE		(-13)
+#define PFE_CHECKSUM		(-14)
 
 /*
  * error in UNIX system call or library routine
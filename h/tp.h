@@ -0,0 +1,59 @@
+#ifndef __TP_H__
+#define __TP_H__
+
+/****************************************************************************
+ * tp.h: external interface definition for the TP (task pool) layer
+ ****************************************************************************/
+
+/*
+ * The task pool runs data-parallel loops on a fixed set of worker
+ * threads.  TP_ParallelFor splits [lo, hi) into one contiguous share per
+ * worker; each worker takes morsels of at most `morsel' items from the
+ * front of its share, and a worker that runs dry steals the back half of
+ * another worker's remaining share, so skewed morsels still balance.  The
+ * calling thread is worker 0 and the call returns when every item is
+ * done.  func(arg, lo, hi, worker) processes items [lo, hi); worker
+ * (0 .. TP_NumWorkers()-1) lets it keep per-thread state without locks.
+ * func must not call TP_ParallelFor itself.
+ */
+#define TP_MAXWORKERS	64
+#define TP_WORKERS_ENV	"MINIREL_TP_WORKERS"
+
+typedef void (*TPfunc)(void *arg, int lo, int hi, int worker);
+
+/*
+ * prototypes for TP-layer functions
+ *
+ * TP_Init starts nworkers workers, the calling thread included; 0 means
+ * the value of TP_WORKERS_ENV or else the number of online processors,
+ * capped at TP_MAXWORKERS.  A count above TP_MAXWORKERS given by the
+ * caller or TP_WORKERS_ENV fails with TPE_INVALIDPARA.
+ */
+int	TP_Init(int nworkers);
+int	TP_NumWorkers(void);
+int	TP_ParallelFor(int lo, int hi, int morsel, TPfunc func, void *arg);
+void	TP_Shutdown(void);
+void	TP_PrintError(const char *errString);
+
+/******************************************************************************/
+/*	Error codes definition			  			      */
+/******************************************************************************/
+#define TP_NERRORS		5	/* number of error codes used */
+
+#define TPE_OK			0	/* TP routine successful */
+#define TPE_NOTINIT		(-1)	/* TP_Init not called */
+#define TPE_INITDONE		(-2)	/* TP_Init called twice */
+#define TPE_INVALIDPARA		(-3)	/* invalid worker count or morsel */
+#define TPE_NOMEM		(-4)	/* out of memory */
+
+/*
+ * error in UNIX system call or library routine
+ */
+#define TPE_UNIX		(-100)
+
+/*
+ * most recent TP error code
+ */
+extern int TPerrno;
+
+#endif
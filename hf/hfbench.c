@@ -0,0 +1,109 @@
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include "minirel.h"
+#include "hf.h"
+
+#define RECSIZE 80
+#define NUMBER  100000
+#define FILE1 "benchfile"
+
+/****************************************************************/
+/* hfbench:                                                     */
+/* Measure HF_InsertRec throughput into a fresh file, then      */
+/* delete a random half of the records and measure it again     */
+/* while the inserts refill the scattered free slots.  With a   */
+/* free-space map both rates should be about the same.          */
+/****************************************************************/
+
+static RECID recids[NUMBER];
+
+double now(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/* insert n records, remembering their RECIDs from recids[first] on */
+double insert_recs(int fd, int first, int n)
+{
+  int i;
+  char recbuf[RECSIZE];
+  double start;
+
+  start = now();
+  for (i = first; i < first + n; i++)
+  {
+     memset(recbuf, ' ', RECSIZE);
+     sprintf(recbuf, "record%d", i);
+     recids[i] = HF_InsertRec(fd, recbuf);
+     if (!HF_ValidRecId(fd, recids[i]))
+     {
+        HF_PrintError("Problem inserting record.\n");
+        exit(1);
+     }
+  }
+  return n / (now() - start);
+}
+
+int main()
+{
+  int i, j, fd;
+  RECID tmp;
+  double before, after;
+
+  HF_Init();
+
+  /* making sure FILE1 doesn't exist */
+  unlink(FILE1);
+
+  if (HF_CreateFile(FILE1, RECSIZE) != HFE_OK)
+  {
+     HF_PrintError("Problem creating HF file.\n");
+     exit(1);
+  }
+  if ((fd = HF_OpenFile(FILE1)) < 0)
+  {
+     HF_PrintError("Problem opening HF file.\n");
+     exit(1);
+  }
+
+  /* insert into an empty file */
+  before = insert_recs(fd, 0, NUMBER);
+
+  /* delete a random half of the records */
+  srand(1);
+  for (i = NUMBER - 1; i > 0; i--)
+  {
+     j = rand() % (i + 1);
+     tmp = recids[i]; recids[i] = recids[j]; recids[j] = tmp;
+  }
+  for (i = 0; i < NUMBER / 2; i++)
+  {
+     if (HF_DeleteRec(fd, recids[i]) != HFE_OK)
+     {
+        HF_PrintError("Problem deleting record.\n");
+        exit(1);
+     }
+  }
+
+  /* refill the holes */
+  after = insert_recs(fd, 0, NUMBER / 2);
+
+  if (HF_CloseFile(fd) != HFE_OK)
+  {
+     HF_PrintError("Problem closing file.\n");
+     exit(1);
+  }
+  unlink(FILE1);
+
+  printf("%d records of %d bytes\n", NUMBER, RECSIZE);
+  printf("insert into empty file:       %10.0f records/sec\n", before);
+  printf("insert after 50%% deleted:     %10.0f records/sec\n", after);
+  return 0;
+}
@@ -0,0 +1,129 @@
+/****************************************************************************
+ * hfpred.c: scan predicate binding for the HF layer
+ ****************************************************************************/
+
+#include <string.h>
+#include "minirel.h"
+#include "hf.h"
+#include "hfpred.h"
+
+/*
+ * one comparison function per (type, operator); attributes and values are
+ * copied out because records are not aligned for int or float
+ */
+#define HF_NUMCMP(name, type, OP)					\
+static bool_t name(const char *attr, const char *value, int attrLength)\
+{									\
+    type a, v;								\
+									\
+    memcpy(&a, attr, sizeof(type));					\
+    memcpy(&v, value, sizeof(type));					\
+    return (a OP v) ? TRUE : FALSE;					\
+}
+
+/* strings compare up to attrLength bytes or the first NUL */
+#define HF_STRCMP(name, OP)						\
+static bool_t name(const char *attr, const char *value, int attrLength)\
+{									\
+    return (strncmp(attr, value, attrLength) OP 0) ? TRUE : FALSE;	\
+}
+
+HF_NUMCMP(eqint, int, ==)
+HF_NUMCMP(ltint, int, <)
+HF_NUMCMP(gtint, int, >)
+HF_NUMCMP(leint, int, <=)
+HF_NUMCMP(geint, int, >=)
+HF_NUMCMP(neint, int, !=)
+
+HF_NUMCMP(eqreal, float, ==)
+HF_NUMCMP(ltreal, float, <)
+HF_NUMCMP(gtreal, float, >)
+HF_NUMCMP(lereal, float, <=)
+HF_NUMCMP(gereal, float, >=)
+HF_NUMCMP(nereal, float, !=)
+
+HF_STRCMP(eqstr, ==)
+HF_STRCMP(ltstr, <)
+HF_STRCMP(gtstr, >)
+HF_STRCMP(lestr, <=)
+HF_STRCMP(gestr, >=)
+HF_STRCMP(nestr, !=)
+
+static bool_t matchall(const char *attr, const char *value, int attrLength)
+{
+    return TRUE;
+}
+
+/*
+ * comparison tables, indexed by op - EQ_OP (EQ_OP .. NE_OP)
+ */
+static HFpredfn inttab[]  = { eqint,  ltint,  gtint,  leint,  geint,  neint };
+static HFpredfn realtab[] = { eqreal, ltreal, gtreal, lereal, gereal, nereal };
+static HFpredfn strtab[]  = { eqstr,  ltstr,  gtstr,  lestr,  gestr,  nestr };
+
+int HF_BindPred(const HFpred *pred, HFpredfn *match)
+{
+    HFpredfn *tab;
+
+    switch (pred->attrType) {
+    case INT_TYPE:
+	if (pred->attrLength != sizeof(int))
+	    return HFE_ATTRLENGTH;
+	tab = inttab;
+	break;
+    case REAL_TYPE:
+	if (pred->attrLength != sizeof(float))
+	    return HFE_ATTRLENGTH;
+	tab = realtab;
+	break;
+    case STRING_TYPE:
+	if (pred->attrLength <= 0)
+	    return HFE_ATTRLENGTH;
+	tab = strtab;
+	break;
+    default:
+	return HFE_ATTRTYPE;
+    }
+    if (pred->attrOffset < 0)
+	return HFE_ATTROFFSET;
+    if (pred->op < EQ_OP || pred->op > ALL_OP)
+	return HFE_OPERATOR;
+
+    if (pred->op == ALL_OP || pred->value == NULL)
+	*match = matchall;
+    else
+	*match = tab[pred->op - EQ_OP];
+    return HFE_OK;
+}
+
+int HF_BindPreds(int npreds, const HFpred preds[], HFbound bound[])
+{
+    int i, err;
+
+    if (npreds < 1 || npreds > HF_MAXPREDS)
+	return HFE_NPREDS;
+    for (i = 0; i < npreds; i++) {
+	if ((err = HF_BindPred(&preds[i], &bound[i].match)) != HFE_OK)
+	    return err;
+	bound[i].attrOffset = preds[i].attrOffset;
+	bound[i].attrLength = preds[i].attrLength;
+	bound[i].value = preds[i].value;
+    }
+    return HFE_OK;
+}
+
+bool_t HF_MatchPreds(int npreds, const HFbound bound[], const char *record,
+		int recLen)
+{
+    int i;
+
+    for (i = 0; i < npreds; i++) {
+	if (bound[i].match == matchall)
+	    continue;
+	if (bound[i].attrOffset + bound[i].attrLength > recLen
+	    || !(*bound[i].match)(record + bound[i].attrOffset,
+				  bound[i].value, bound[i].attrLength))
+	    return FALSE;
+    }
+    return TRUE;
+}
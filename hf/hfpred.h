@@ -0,0 +1,44 @@
+#ifndef __HFPRED_H__
+#define __HFPRED_H__
+
+/****************************************************************************
+ * hfpred.h: scan predicate binding for the HF layer (internal)
+ *
+ * A scan predicate is bound once, when the scan is opened, to a comparison
+ * function specific to its attribute type and operator, so the per-record
+ * loop of HF_FindNextRec calls through a pointer instead of switching on
+ * the type and operator of every predicate for every record.
+ ****************************************************************************/
+
+/*
+ * TRUE if the attribute at attr satisfies "attr op value"
+ */
+typedef bool_t (*HFpredfn)(const char *attr, const char *value,
+			int attrLength);
+
+/*
+ * a predicate of an open scan, bound to its comparison function
+ */
+typedef struct {
+    HFpredfn	match;		/* comparison for (attrType, op) */
+    int		attrOffset;	/* attribute offset in the record */
+    int		attrLength;	/* attribute length */
+    const char	*value;		/* comparison value */
+} HFbound;
+
+/*
+ * HF_BindPred checks one predicate and sets *match to its comparison
+ * function; ALL_OP or a NULL value match every record.  It returns HFE_OK,
+ * HFE_ATTRTYPE, HFE_ATTRLENGTH, HFE_ATTROFFSET or HFE_OPERATOR.
+ * HF_BindPreds binds npreds (1..HF_MAXPREDS) predicates into bound[], or
+ * returns HFE_NPREDS or the first error of HF_BindPred.
+ * HF_MatchPreds tests a record of recLen bytes against all bound
+ * predicates; a predicate past the end of the record never matches
+ * unless it matches every record.
+ */
+int    HF_BindPred	(const HFpred *pred, HFpredfn *match);
+int    HF_BindPreds	(int npreds, const HFpred preds[], HFbound bound[]);
+bool_t HF_MatchPreds	(int npreds, const HFbound bound[], const char *record,
+			int recLen);
+
+#endif
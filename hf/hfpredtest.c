@@ -0,0 +1,212 @@
+/*
+ * hfpredtest: check the comparison functions bound by HF_BindPred for
+ * every type and operator, and conjunctions through HF_MatchPreds,
+ * against a switch on type and operator over random records.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "minirel.h"
+#include "hf.h"
+#include "hfpred.h"
+
+#define NRECS       2000
+#define PROBES      50
+#define STRSIZE     8
+
+struct rec_struct {
+   char  string_val[STRSIZE];
+   float float_val;
+   int   int_val;
+};
+
+static struct rec_struct recs[NRECS];
+
+static const char *typename[] = { "int", "real", "string" };
+static const char types[] = { INT_TYPE, REAL_TYPE, STRING_TYPE };
+static const int offsets[] = {
+   (int)((char *)&recs[0].int_val - (char *)&recs[0]),
+   (int)((char *)&recs[0].float_val - (char *)&recs[0]),
+   0
+};
+static const int lengths[] = { sizeof(int), sizeof(float), STRSIZE };
+
+/* reference: one switch on type and operator per record */
+bool_t reference(const HFpred *pred, const char *record)
+{
+   const char *attr = record + pred->attrOffset;
+   int c, ia, iv;
+   float fa, fv;
+
+   if (pred->op == ALL_OP || pred->value == NULL)
+      return TRUE;
+   switch (pred->attrType) {
+   case INT_TYPE:
+      memcpy(&ia, attr, sizeof(int));
+      memcpy(&iv, pred->value, sizeof(int));
+      c = (ia > iv) - (ia < iv);
+      break;
+   case REAL_TYPE:
+      memcpy(&fa, attr, sizeof(float));
+      memcpy(&fv, pred->value, sizeof(float));
+      c = (fa > fv) - (fa < fv);
+      break;
+   default:
+      c = strncmp(attr, pred->value, pred->attrLength);
+      break;
+   }
+   switch (pred->op) {
+   case EQ_OP: return c == 0;
+   case LT_OP: return c < 0;
+   case GT_OP: return c > 0;
+   case LE_OP: return c <= 0;
+   case GE_OP: return c >= 0;
+   default:    return c != 0;
+   }
+}
+
+/* a random predicate on attribute t, with its value in buf */
+void randpred(HFpred *pred, int t, int op, char *buf)
+{
+   int ival;
+   float rval;
+
+   pred->attrType = types[t];
+   pred->attrLength = lengths[t];
+   pred->attrOffset = offsets[t];
+   pred->op = op;
+   pred->value = buf;
+   memset(buf, '\0', STRSIZE + 1);
+   if (t == 0) {
+      ival = rand() % 24 - 12;
+      memcpy(buf, &ival, sizeof(int));
+   } else if (t == 1) {
+      rval = (float)(rand() % 24 - 12) / 4;
+      memcpy(buf, &rval, sizeof(float));
+   } else
+      sprintf(buf, "s%02d", rand() % 24);
+}
+
+/* every type and operator on its own */
+void testsingle(void)
+{
+   HFpred pred;
+   HFpredfn match;
+   char buf[STRSIZE + 1];
+   int t, op, p, i, wrong, matches;
+
+   for (t = 0; t < 3; t++)
+      for (op = EQ_OP; op <= ALL_OP; op++) {
+         wrong = matches = 0;
+         for (p = 0; p < PROBES; p++) {
+            randpred(&pred, t, op, buf);
+            if (HF_BindPred(&pred, &match) != HFE_OK) {
+               printf("HF_BindPred failed\n");
+               exit(1);
+            }
+            for (i = 0; i < NRECS; i++) {
+               if ((*match)((char *)&recs[i] + pred.attrOffset, pred.value,
+                            pred.attrLength) != reference(&pred, (char *)&recs[i]))
+                  wrong++;
+               matches += reference(&pred, (char *)&recs[i]);
+            }
+         }
+         printf("%-6s op %d: %6d matches, %d wrong\n",
+                typename[t], op, matches, wrong);
+      }
+}
+
+/* conjunctions of 1..HF_MAXPREDS random predicates */
+void testconj(void)
+{
+   HFpred preds[HF_MAXPREDS];
+   HFbound bound[HF_MAXPREDS];
+   char bufs[HF_MAXPREDS][STRSIZE + 1];
+   int n, j, p, i, ok, wrong, matches;
+
+   for (n = 1; n <= HF_MAXPREDS; n++) {
+      wrong = matches = 0;
+      for (p = 0; p < PROBES; p++) {
+         for (j = 0; j < n; j++)
+            randpred(&preds[j], rand() % 3, rand() % ALL_OP + 1, bufs[j]);
+         if (HF_BindPreds(n, preds, bound) != HFE_OK) {
+            printf("HF_BindPreds failed\n");
+            exit(1);
+         }
+         for (i = 0; i < NRECS; i++) {
+            ok = TRUE;
+            for (j = 0; j < n; j++)
+               ok = ok && reference(&preds[j], (char *)&recs[i]);
+            if (HF_MatchPreds(n, bound, (char *)&recs[i],
+                              sizeof(struct rec_struct)) != ok)
+               wrong++;
+            matches += ok;
+         }
+      }
+      printf("%d preds: %6d matches, %d wrong\n", n, matches, wrong);
+   }
+}
+
+/* bad predicates and records too short for a predicate */
+void testerrors(void)
+{
+   HFpred pred;
+   HFpredfn match;
+   HFbound bound[1];
+   char buf[STRSIZE + 1];
+
+   randpred(&pred, 0, EQ_OP, buf);
+   pred.attrLength = 2;
+   printf("bad int length: %s\n",
+          HF_BindPred(&pred, &match) == HFE_ATTRLENGTH ? "rejected" : "accepted");
+   randpred(&pred, 0, EQ_OP, buf);
+   pred.attrType = 'x';
+   printf("bad type: %s\n",
+          HF_BindPred(&pred, &match) == HFE_ATTRTYPE ? "rejected" : "accepted");
+   randpred(&pred, 0, EQ_OP, buf);
+   pred.attrOffset = -1;
+   printf("bad offset: %s\n",
+          HF_BindPred(&pred, &match) == HFE_ATTROFFSET ? "rejected" : "accepted");
+   randpred(&pred, 0, ALL_OP + 1, buf);
+   printf("bad operator: %s\n",
+          HF_BindPred(&pred, &match) == HFE_OPERATOR ? "rejected" : "accepted");
+   randpred(&pred, 0, EQ_OP, buf);
+   printf("no predicates: %s\n",
+          HF_BindPreds(0, &pred, bound) == HFE_NPREDS ? "rejected" : "accepted");
+   printf("too many predicates: %s\n",
+          HF_BindPreds(HF_MAXPREDS + 1, &pred, bound) == HFE_NPREDS ?
+          "rejected" : "accepted");
+
+   randpred(&pred, 0, GE_OP, buf);
+   memset(buf, '\0', sizeof(int));		/* int_val >= 0 */
+   recs[0].int_val = 1;
+   HF_BindPreds(1, &pred, bound);
+   printf("past end of record: %s\n",
+          HF_MatchPreds(1, bound, (char *)&recs[0], pred.attrOffset + 2) ?
+          "matched" : "not matched");
+   pred.op = ALL_OP;
+   HF_BindPreds(1, &pred, bound);
+   printf("past end of record, ALL_OP: %s\n",
+          HF_MatchPreds(1, bound, (char *)&recs[0], pred.attrOffset + 2) ?
+          "matched" : "not matched");
+}
+
+int main()
+{
+   int i;
+
+   srand(1);
+   /* small value ranges so that every operator sees equal values */
+   for (i = 0; i < NRECS; i++) {
+      memset(recs[i].string_val, '\0', STRSIZE);
+      sprintf(recs[i].string_val, "s%02d", rand() % 20);
+      recs[i].float_val = (float)(rand() % 20 - 10) / 4;
+      recs[i].int_val = rand() % 20 - 10;
+   }
+
+   testsingle();
+   testconj();
+   testerrors();
+   return 0;
+}
@@ -0,0 +1,255 @@
+/****************************************************************************
+ * hfsimd.c: page-at-a-time column filters for the HF layer
+ ****************************************************************************/
+
+#include <string.h>
+#include "minirel.h"
+#include "hf.h"
+#include "hfpred.h"
+#include "hfsimd.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define HF_HAVE_SIMD
+#endif
+
+int HFsimdMax = HF_SIMD_AVX2;
+
+/*
+ * operator -> HF_CMP_ bits, indexed by op - EQ_OP (EQ_OP .. NE_OP)
+ */
+static const int opbits[] = {
+    HF_CMP_EQ,			/* EQ_OP */
+    HF_CMP_LT,			/* LT_OP */
+    HF_CMP_GT,			/* GT_OP */
+    HF_CMP_LT | HF_CMP_EQ,	/* LE_OP */
+    HF_CMP_GT | HF_CMP_EQ,	/* GE_OP */
+    HF_CMP_EQ | HF_CMP_NOT	/* NE_OP */
+};
+
+/*
+ * Every kernel computes the lt, eq and gt bits of each record and keeps
+ * those selected by ops, inverted for HF_CMP_NOT; a NaN is none of the
+ * three, so it fails every operator but NE_OP, as with the C operators
+ * in hfpred.c.  The SIMD kernels do it for 8 (or 4) records at a time
+ * with the selections as lane masks set up once, and leave the last
+ * records of the page to the scalar loop.
+ */
+#define HF_SELECT(lt, eq, gt, wl, we, wg, inv) \
+	((((lt) & (wl)) | ((eq) & (we)) | ((gt) & (wg))) ^ (inv))
+
+/*
+ * scalar loops over records first .. nrecs-1
+ */
+static void scanint(const char *col, int first, int nrecs, int stride,
+		const char *value, int ops, unsigned char bitmap[])
+{
+    int wl = (ops & HF_CMP_LT) != 0, we = (ops & HF_CMP_EQ) != 0;
+    int wg = (ops & HF_CMP_GT) != 0, inv = (ops & HF_CMP_NOT) != 0;
+    int i, a, v, keep;
+
+    memcpy(&v, value, sizeof(int));
+    for (i = first; i < nrecs; i++) {
+	memcpy(&a, col + i * stride, sizeof(int));
+	keep = HF_SELECT(a < v, a == v, a > v, wl, we, wg, inv);
+	bitmap[i >> 3] &= ~(!keep << (i & 7));
+    }
+}
+
+static void scanreal(const char *col, int first, int nrecs, int stride,
+		const char *value, int ops, unsigned char bitmap[])
+{
+    int wl = (ops & HF_CMP_LT) != 0, we = (ops & HF_CMP_EQ) != 0;
+    int wg = (ops & HF_CMP_GT) != 0, inv = (ops & HF_CMP_NOT) != 0;
+    int i, keep;
+    float a, v;
+
+    memcpy(&v, value, sizeof(float));
+    for (i = first; i < nrecs; i++) {
+	memcpy(&a, col + i * stride, sizeof(float));
+	keep = HF_SELECT(a < v, a == v, a > v, wl, we, wg, inv);
+	bitmap[i >> 3] &= ~(!keep << (i & 7));
+    }
+}
+
+static void filterint(const char *col, int nrecs, int stride,
+		const char *value, int ops, unsigned char bitmap[])
+{
+    scanint(col, 0, nrecs, stride, value, ops, bitmap);
+}
+
+static void filterreal(const char *col, int nrecs, int stride,
+		const char *value, int ops, unsigned char bitmap[])
+{
+    scanreal(col, 0, nrecs, stride, value, ops, bitmap);
+}
+
+#ifdef HF_HAVE_SIMD
+/*
+ * SSE2, always there on x86-64: it has no gather, so the 4 attributes are
+ * copied into a vector, then compared at once
+ */
+static void filterint_sse2(const char *col, int nrecs, int stride,
+		const char *value, int ops, unsigned char bitmap[])
+{
+    int wl = (ops & HF_CMP_LT) ? 0xf : 0, we = (ops & HF_CMP_EQ) ? 0xf : 0;
+    int wg = (ops & HF_CMP_GT) ? 0xf : 0, inv = (ops & HF_CMP_NOT) ? 0xf : 0;
+    int i, j, v, lanes[4], keep;
+    __m128i vv, kk;
+
+    memcpy(&v, value, sizeof(int));
+    vv = _mm_set1_epi32(v);
+    for (i = 0; i + 4 <= nrecs; i += 4) {
+	for (j = 0; j < 4; j++)
+	    memcpy(&lanes[j], col + (i + j) * stride, sizeof(int));
+	kk = _mm_loadu_si128((const __m128i *)lanes);
+	keep = HF_SELECT(
+		_mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(kk, vv))),
+		_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(kk, vv))),
+		_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(kk, vv))),
+		wl, we, wg, inv);
+	bitmap[i >> 3] &= ~((~keep & 0xf) << (i & 7));
+    }
+    scanint(col, i, nrecs, stride, value, ops, bitmap);
+}
+
+static void filterreal_sse2(const char *col, int nrecs, int stride,
+		const char *value, int ops, unsigned char bitmap[])
+{
+    int wl = (ops & HF_CMP_LT) ? 0xf : 0, we = (ops & HF_CMP_EQ) ? 0xf : 0;
+    int wg = (ops & HF_CMP_GT) ? 0xf : 0, inv = (ops & HF_CMP_NOT) ? 0xf : 0;
+    int i, j, keep;
+    float v, lanes[4];
+    __m128 vv, kk;
+
+    memcpy(&v, value, sizeof(float));
+    vv = _mm_set1_ps(v);
+    for (i = 0; i + 4 <= nrecs; i += 4) {
+	for (j = 0; j < 4; j++)
+	    memcpy(&lanes[j], col + (i + j) * stride, sizeof(float));
+	kk = _mm_loadu_ps(lanes);
+	keep = HF_SELECT(_mm_movemask_ps(_mm_cmplt_ps(kk, vv)),
+		_mm_movemask_ps(_mm_cmpeq_ps(kk, vv)),
+		_mm_movemask_ps(_mm_cmpgt_ps(kk, vv)),
+		wl, we, wg, inv);
+	bitmap[i >> 3] &= ~((~keep & 0xf) << (i & 7));
+    }
+    scanreal(col, i, nrecs, stride, value, ops, bitmap);
+}
+
+/*
+ * AVX2: the 8 attributes are gathered with one instruction, using
+ * record offsets 0, stride, .. 7 * stride as the indexes
+ */
+__attribute__((target("avx2")))
+static void filterint_avx2(const char *col, int nrecs, int stride,
+		const char *value, int ops, unsigned char bitmap[])
+{
+    int wl = (ops & HF_CMP_LT) ? 0xff : 0, we = (ops & HF_CMP_EQ) ? 0xff : 0;
+    int wg = (ops & HF_CMP_GT) ? 0xff : 0, inv = (ops & HF_CMP_NOT) ? 0xff : 0;
+    int i, v;
+    __m256i idx, vv, kk;
+
+    memcpy(&v, value, sizeof(int));
+    vv = _mm256_set1_epi32(v);
+    idx = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+			     _mm256_set1_epi32(stride));
+    for (i = 0; i + 8 <= nrecs; i += 8) {
+	kk = _mm256_i32gather_epi32((const int *)(col + i * stride), idx, 1);
+	bitmap[i >> 3] &= HF_SELECT(
+		_mm256_movemask_ps(_mm256_castsi256_ps(
+			_mm256_cmpgt_epi32(vv, kk))),
+		_mm256_movemask_ps(_mm256_castsi256_ps(
+			_mm256_cmpeq_epi32(kk, vv))),
+		_mm256_movemask_ps(_mm256_castsi256_ps(
+			_mm256_cmpgt_epi32(kk, vv))),
+		wl, we, wg, inv);
+    }
+    scanint(col, i, nrecs, stride, value, ops, bitmap);
+}
+
+__attribute__((target("avx2")))
+static void filterreal_avx2(const char *col, int nrecs, int stride,
+		const char *value, int ops, unsigned char bitmap[])
+{
+    int wl = (ops & HF_CMP_LT) ? 0xff : 0, we = (ops & HF_CMP_EQ) ? 0xff : 0;
+    int wg = (ops & HF_CMP_GT) ? 0xff : 0, inv = (ops & HF_CMP_NOT) ? 0xff : 0;
+    int i;
+    float v;
+    __m256i idx;
+    __m256 vv, kk;
+
+    memcpy(&v, value, sizeof(float));
+    vv = _mm256_set1_ps(v);
+    idx = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+			     _mm256_set1_epi32(stride));
+    for (i = 0; i + 8 <= nrecs; i += 8) {
+	kk = _mm256_i32gather_ps((const float *)(col + i * stride), idx, 1);
+	bitmap[i >> 3] &= HF_SELECT(
+		_mm256_movemask_ps(_mm256_cmp_ps(kk, vv, _CMP_LT_OQ)),
+		_mm256_movemask_ps(_mm256_cmp_ps(kk, vv, _CMP_EQ_OQ)),
+		_mm256_movemask_ps(_mm256_cmp_ps(kk, vv, _CMP_GT_OQ)),
+		wl, we, wg, inv);
+    }
+    scanreal(col, i, nrecs, stride, value, ops, bitmap);
+}
+#endif
+
+/*
+ * ALL_OP or a NULL value: every record matches
+ */
+static void filterall(const char *col, int nrecs, int stride,
+		const char *value, int ops, unsigned char bitmap[])
+{
+}
+
+int HF_SimdLevel(void)
+{
+    int level = HF_SIMD_NONE;
+
+#ifdef HF_HAVE_SIMD
+    level = HF_SIMD_SSE2;
+    if (__builtin_cpu_supports("avx2"))
+	level = HF_SIMD_AVX2;
+#endif
+    return (level < HFsimdMax) ? level : HFsimdMax;
+}
+
+int HF_BindFilter(const HFpred *pred, HFcolfilter *f)
+{
+    HFpredfn match;
+    int err, level;
+
+    if (pred->attrType != INT_TYPE && pred->attrType != REAL_TYPE)
+	return HFE_ATTRTYPE;
+    if ((err = HF_BindPred(pred, &match)) != HFE_OK)
+	return err;
+
+    f->attrOffset = pred->attrOffset;
+    f->value = pred->value;
+    if (pred->op == ALL_OP || pred->value == NULL) {
+	f->filter = filterall;
+	f->ops = 0;
+	return HFE_OK;
+    }
+    f->ops = opbits[pred->op - EQ_OP];
+
+    level = HF_SimdLevel();
+    f->filter = (pred->attrType == INT_TYPE) ? filterint : filterreal;
+#ifdef HF_HAVE_SIMD
+    if (level == HF_SIMD_SSE2)
+	f->filter = (pred->attrType == INT_TYPE) ?
+		filterint_sse2 : filterreal_sse2;
+    else if (level == HF_SIMD_AVX2)
+	f->filter = (pred->attrType == INT_TYPE) ?
+		filterint_avx2 : filterreal_avx2;
+#endif
+    return HFE_OK;
+}
+
+void HF_FilterPage(const HFcolfilter *f, const char *recs, int nrecs,
+		int stride, unsigned char bitmap[])
+{
+    (*f->filter)(recs + f->attrOffset, nrecs, stride, f->value, f->ops,
+		 bitmap);
+}
@@ -0,0 +1,65 @@
+#ifndef __HFSIMD_H__
+#define __HFSIMD_H__
+
+/****************************************************************************
+ * hfsimd.h: page-at-a-time column filters for the HF layer (internal)
+ *
+ * On fixed-size files HF_FindNextBatch evaluates each INT_TYPE or
+ * REAL_TYPE predicate for a whole page at once.  The attribute column is
+ * gathered from the fixed-stride records and compared with AVX2 (8
+ * records per compare, with a hardware gather) or SSE2 (4 records), or a
+ * scalar loop, chosen by HF_BindFilter from the CPU.  STRING_TYPE
+ * predicates are tested record by record with HF_MatchPreds (hfpred.h).
+ ****************************************************************************/
+
+/*
+ * kernel levels, as returned by HF_SimdLevel
+ */
+#define HF_SIMD_NONE	0	/* scalar loop */
+#define HF_SIMD_SSE2	1	/* 4 records per compare */
+#define HF_SIMD_AVX2	2	/* 8 records per compare, gathered */
+
+/*
+ * the match bitmap holds one bit per record: bit (i % 8) of bitmap[i / 8]
+ * for record i.  A filter clears the bits of the records that fail
+ * "attr op value" and leaves the others alone, so filters applied one
+ * after the other to a bitmap that starts all ones leave the records that
+ * satisfy every predicate.  col points to the attribute of record 0, and
+ * record i's attribute is at col + i * stride.
+ */
+typedef void (*HFfilterfn)(const char *col, int nrecs, int stride,
+			const char *value, int ops, unsigned char bitmap[]);
+
+/*
+ * a predicate bound to its filter
+ */
+typedef struct {
+    HFfilterfn	filter;		/* kernel for the type and CPU */
+    int		attrOffset;	/* attribute offset in the record */
+    int		ops;		/* the operator as HF_CMP_ bits */
+    const char	*value;		/* comparison value */
+} HFcolfilter;
+
+#define HF_CMP_LT	1	/* keep attr < value */
+#define HF_CMP_EQ	2	/* keep attr == value */
+#define HF_CMP_GT	4	/* keep attr > value */
+#define HF_CMP_NOT	8	/* then invert (NE_OP is EQ|NOT) */
+
+/*
+ * HF_BindFilter binds an INT_TYPE or REAL_TYPE predicate to the filter
+ * for its type at HF_SimdLevel(); it returns HFE_ATTRTYPE for other types
+ * and the errors of HF_BindPred otherwise.  HF_FilterPage applies a bound
+ * filter to the nrecs records of a page, stride bytes apart from recs.
+ */
+int  HF_BindFilter	(const HFpred *pred, HFcolfilter *f);
+void HF_FilterPage	(const HFcolfilter *f, const char *recs, int nrecs,
+			int stride, unsigned char bitmap[]);
+
+/*
+ * HF_SimdLevel is the best level the CPU supports, capped at HFsimdMax
+ * (HF_SIMD_AVX2 unless lowered, e.g. to test the other kernels)
+ */
+int  HF_SimdLevel	(void);
+extern int HFsimdMax;
+
+#endif
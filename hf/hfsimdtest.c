@@ -0,0 +1,130 @@
+/*
+ * hfsimdtest: check the column filters of every kernel level against the
+ * comparison functions of HF_BindPred applied record by record, on random
+ * pages of several record strides and sizes, with an AND into a random
+ * bitmap as for a conjunction.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "minirel.h"
+#include "hf.h"
+#include "hfpred.h"
+#include "hfsimd.h"
+
+#define MAXRECS     600
+#define MAXSTRIDE   100
+#define PROBES      20
+
+static char          page[MAXRECS * MAXSTRIDE];
+static unsigned char bitmap[MAXRECS / 8 + 2], expect[MAXRECS / 8 + 2];
+
+static const char *levelname[] = { "scalar", "sse2", "avx2" };
+static const int strides[] = { 4, 8, 12, 13, 100 };
+
+/* fill the column of nrecs records with small values, and a NaN or two */
+void fillpage(char attrType, int nrecs, int stride, int offset)
+{
+   int i, ival;
+   float rval, zero = 0;
+
+   for (i = 0; i < nrecs; i++) {
+      if (attrType == INT_TYPE) {
+         ival = rand() % 16 - 8;
+         memcpy(page + i * stride + offset, &ival, sizeof(int));
+      } else {
+         rval = (rand() % 50 == 0) ? zero / zero : (float)(rand() % 16 - 8) / 4;
+         memcpy(page + i * stride + offset, &rval, sizeof(float));
+      }
+   }
+}
+
+/* all filters of one type at one level; returns the mismatched bitmaps */
+int testlevel(char attrType, int level, int *nfilters)
+{
+   HFpred pred;
+   HFpredfn match;
+   HFcolfilter f;
+   char value[sizeof(int)];
+   int s, nrecs, offset, op, p, i, ival, wrong = 0;
+   float rval;
+
+   HFsimdMax = level;
+   for (s = 0; s < sizeof(strides) / sizeof(strides[0]); s++)
+      for (nrecs = 0; nrecs <= MAXRECS; nrecs += (nrecs < 40) ? 1 : 71) {
+         offset = (strides[s] > 4) ? rand() % (strides[s] - 3) : 0;
+         fillpage(attrType, nrecs, strides[s], offset);
+         for (op = EQ_OP; op <= ALL_OP; op++)
+            for (p = 0; p < PROBES; p++) {
+               if (attrType == INT_TYPE) {
+                  ival = rand() % 20 - 10;
+                  memcpy(value, &ival, sizeof(int));
+               } else {
+                  rval = (float)(rand() % 20 - 10) / 4;
+                  memcpy(value, &rval, sizeof(float));
+               }
+               pred.attrType = attrType;
+               pred.attrLength = 4;
+               pred.attrOffset = offset;
+               pred.op = op;
+               pred.value = value;
+               if (HF_BindFilter(&pred, &f) != HFE_OK
+                   || HF_BindPred(&pred, &match) != HFE_OK) {
+                  printf("binding failed\n");
+                  exit(1);
+               }
+
+               /* random bits, past nrecs too, which must stay as they are */
+               for (i = 0; i < sizeof(bitmap); i++)
+                  bitmap[i] = expect[i] = rand();
+               for (i = 0; i < nrecs; i++)
+                  if (!(*match)(page + i * strides[s] + offset, value, 4))
+                     expect[i >> 3] &= ~(1 << (i & 7));
+
+               HF_FilterPage(&f, page, nrecs, strides[s], bitmap);
+               if (memcmp(bitmap, expect, sizeof(bitmap)) != 0)
+                  wrong++;
+               (*nfilters)++;
+            }
+      }
+   return wrong;
+}
+
+int main()
+{
+   HFpred pred;
+   HFcolfilter f;
+   int level, wrong, nfilters;
+
+   srand(1);
+   for (level = HF_SIMD_NONE; level <= HF_SIMD_AVX2; level++) {
+      HFsimdMax = level;
+      if (HF_SimdLevel() != level) {
+         printf("%-6s: not supported by this CPU, skipped\n",
+                levelname[level]);
+         continue;
+      }
+      nfilters = 0;
+      wrong = testlevel(INT_TYPE, level, &nfilters);
+      printf("%-6s int : %d filters, %d wrong\n",
+             levelname[level], nfilters, wrong);
+      nfilters = 0;
+      wrong = testlevel(REAL_TYPE, level, &nfilters);
+      printf("%-6s real: %d filters, %d wrong\n",
+             levelname[level], nfilters, wrong);
+   }
+
+   memset(&pred, 0, sizeof(pred));
+   pred.attrType = STRING_TYPE;
+   pred.attrLength = 4;
+   pred.op = EQ_OP;
+   pred.value = "abc";
+   printf("string predicate: %s\n",
+          HF_BindFilter(&pred, &f) == HFE_ATTRTYPE ? "rejected" : "accepted");
+   pred.attrType = INT_TYPE;
+   pred.op = ALL_OP + 1;
+   printf("bad operator: %s\n",
+          HF_BindFilter(&pred, &f) == HFE_OPERATOR ? "rejected" : "accepted");
+   return 0;
+}
@@ -0,0 +1,138 @@
+/****************************************************************************
+ * pfscrub.c: verify the page checksums of every PF file in a database
+ *
+ * usage: pfscrub [dbname]
+ *
+ * Walks the database directory (default: the current directory), checks
+ * the CRC32C trailer of the header and of every page of each PF file, and
+ * reports the bad pages.  Files whose header does not hold a valid page
+ * size are not PF files and are skipped.  Exits with 1 if any page is bad.
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include "minirel.h"
+#include "bf.h"
+#include "pf.h"
+
+static char	pagebuf[MAX_PAGE_SIZE];
+static long	npages, nbad, nbytes;
+
+/*
+ * TRUE if the page was never written (e.g. preallocated by an extent)
+ */
+bool_t zeropage(const char *buf, int pagesize)
+{
+    int i;
+
+    for (i = 0; i < pagesize; i++)
+	if (buf[i] != 0)
+	    return FALSE;
+    return TRUE;
+}
+
+/*
+ * TRUE if the trailer of the page matches its contents
+ */
+bool_t goodpage(const char *buf, int pagesize)
+{
+    unsigned int stored;
+
+    memcpy(&stored, buf + pagesize - PF_CRC_SIZE, PF_CRC_SIZE);
+    nbytes += pagesize;
+    return BF_Crc32c(buf, pagesize - PF_CRC_SIZE) == stored
+	|| zeropage(buf, pagesize);
+}
+
+/*
+ * scrub one file; page -1 is the PF header
+ */
+void scrubfile(const char *fname)
+{
+    PFhdr_str hdr;
+    int unixfd, pagesize, pagenum, n;
+
+    if ((unixfd = open(fname, O_RDONLY)) < 0) {
+	perror(fname);
+	return;
+    }
+
+    /* the page size is in the header, the first page of every PF file */
+    if (read(unixfd, pagebuf, MIN_PAGE_SIZE) != MIN_PAGE_SIZE) {
+	close(unixfd);
+	return;
+    }
+    memcpy(&hdr, pagebuf + PF_PAGE_DATA, sizeof(hdr));
+    pagesize = hdr.pagesize;
+    if (pagesize < MIN_PAGE_SIZE || pagesize > MAX_PAGE_SIZE
+	|| (pagesize & (pagesize - 1)) != 0) {
+	printf("%s: not a PF file, skipped\n", fname);
+	close(unixfd);
+	return;
+    }
+
+    if (lseek(unixfd, 0, SEEK_SET) < 0) {
+	perror(fname);
+	close(unixfd);
+	return;
+    }
+    for (pagenum = -1; (n = read(unixfd, pagebuf, pagesize)) > 0; pagenum++) {
+	if (n != pagesize) {
+	    printf("%s: page %d: short page (%d bytes)\n", fname, pagenum, n);
+	    nbad++;
+	    break;
+	}
+	npages++;
+	if (!goodpage(pagebuf, pagesize)) {
+	    if (pagenum < 0)
+		printf("%s: header: bad checksum\n", fname);
+	    else
+		printf("%s: page %d: bad checksum\n", fname, pagenum);
+	    nbad++;
+	}
+    }
+    if (n < 0)
+	perror(fname);
+    close(unixfd);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *dbname = (argc > 1) ? argv[1] : ".";
+    struct dirent *dp;
+    struct stat st;
+    struct timeval start, end;
+    DIR *dir;
+    double secs;
+    int nfiles = 0;
+
+    if (chdir(dbname) < 0 || (dir = opendir(".")) == NULL) {
+	perror(dbname);
+	exit(2);
+    }
+
+    gettimeofday(&start, NULL);
+    while ((dp = readdir(dir)) != NULL) {
+	if (stat(dp->d_name, &st) < 0 || !S_ISREG(st.st_mode))
+	    continue;
+	scrubfile(dp->d_name);
+	nfiles++;
+    }
+    closedir(dir);
+    gettimeofday(&end, NULL);
+
+    secs = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
+    printf("%d files, %ld pages, %ld bad pages", nfiles, npages, nbad);
+    if (secs > 0)
+	printf(", %.1f MB/s", nbytes / secs / (1024 * 1024));
+    printf("\n");
+
+    exit(nbad ? 1 : 0);
+}
@@ -31,7 +31,7 @@ void writefile(const char *fname)
     }
     printf("\n******** %s opened for write ***********\n",fname);
 
-    for (i=0; i < 2 * BF_MAX_BUFS; i++){
+    for (i=0; i < 2 * BF_NumBufs(); i++){
 	if ((error = PF_AllocPage(fd,&pagenum,&buf))!= PFE_OK){
 printf("PF_AllocPage fails (i=%d)\n",i);
 	    PF_PrintError("first buffer\n");
@@ -0,0 +1,268 @@
+/****************************************************************************
+ * tp.c: TP (task pool) layer, a work-stealing pool for parallel loops
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include "tp.h"
+
+int TPerrno = TPE_OK;
+
+/*
+ * the share of the current loop still owned by one worker: items
+ * [next, end); the owner takes from the front, thieves from the back
+ */
+typedef struct {
+    pthread_mutex_t	lock;
+    int			next;
+    int			end;
+} TPshare;
+
+static int		nworkers = 0;	/* 0 until TP_Init */
+static pthread_t	*threads;	/* workers 1 .. nworkers-1 */
+static TPshare		*shares;	/* one per worker */
+
+static pthread_mutex_t	joblock = PTHREAD_MUTEX_INITIALIZER;	/* one loop at a time */
+static pthread_mutex_t	poollock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t	workcond = PTHREAD_COND_INITIALIZER;	/* new loop or shutdown */
+static pthread_cond_t	donecond = PTHREAD_COND_INITIALIZER;	/* all workers done */
+static int		generation;	/* bumped for every loop */
+static int		active;		/* workers 1.. still in the loop */
+static int		stopping;
+
+static TPfunc		jobfunc;
+static void		*jobarg;
+static int		jobmorsel;
+
+static const char *TPerrmsg[] = {
+    "no error",
+    "TP_Init not called",
+    "TP_Init called twice",
+    "invalid worker count or morsel",
+    "out of memory"
+};
+
+/*
+ * take the next morsel of worker id's own share
+ */
+static int take(int id, int *lo, int *hi)
+{
+    TPshare *sh = &shares[id];
+    int found = 0;
+
+    pthread_mutex_lock(&sh->lock);
+    if (sh->next < sh->end) {
+	*lo = sh->next;
+	*hi = (sh->end - sh->next > jobmorsel) ? sh->next + jobmorsel : sh->end;
+	sh->next = *hi;
+	found = 1;
+    }
+    pthread_mutex_unlock(&sh->lock);
+    return found;
+}
+
+/*
+ * refill worker id's empty share from another worker: the back half of
+ * its remaining items, or all of them if no more than one morsel is left
+ */
+static int steal(int id)
+{
+    TPshare *victim;
+    int i, v, mid, end;
+
+    for (i = 1; i < nworkers; i++) {
+	v = (id + i) % nworkers;
+	victim = &shares[v];
+	pthread_mutex_lock(&victim->lock);
+	if (victim->next >= victim->end) {
+	    pthread_mutex_unlock(&victim->lock);
+	    continue;
+	}
+	end = victim->end;
+	if (end - victim->next > jobmorsel)
+	    mid = victim->next + (end - victim->next) / 2;
+	else
+	    mid = victim->next;
+	victim->end = mid;
+	pthread_mutex_unlock(&victim->lock);
+
+	pthread_mutex_lock(&shares[id].lock);
+	shares[id].next = mid;
+	shares[id].end = end;
+	pthread_mutex_unlock(&shares[id].lock);
+	return 1;
+    }
+    return 0;
+}
+
+/*
+ * run worker id's part of the current loop until no work is left anywhere
+ */
+static void runjob(int id)
+{
+    int lo, hi;
+
+    for (;;) {
+	if (take(id, &lo, &hi))
+	    (*jobfunc)(jobarg, lo, hi, id);
+	else if (!steal(id))
+	    break;
+    }
+}
+
+/*
+ * body of workers 1 .. nworkers-1
+ */
+static void *worker(void *arg)
+{
+    int id = (int)(long)arg;
+    int mygen = 0;
+
+    for (;;) {
+	pthread_mutex_lock(&poollock);
+	while (generation == mygen && !stopping)
+	    pthread_cond_wait(&workcond, &poollock);
+	if (stopping) {
+	    pthread_mutex_unlock(&poollock);
+	    return NULL;
+	}
+	mygen = generation;
+	pthread_mutex_unlock(&poollock);
+
+	runjob(id);
+
+	pthread_mutex_lock(&poollock);
+	if (--active == 0)
+	    pthread_cond_signal(&donecond);
+	pthread_mutex_unlock(&poollock);
+    }
+}
+
+int TP_Init(int n)
+{
+    char *env;
+    int i, rc;
+
+    if (nworkers > 0)
+	return (TPerrno = TPE_INITDONE);
+
+    if (n <= 0 && (env = getenv(TP_WORKERS_ENV)) != NULL)
+	n = atoi(env);
+    /* a count given above the limit is an error; the detected one is capped */
+    if (n > TP_MAXWORKERS)
+	return (TPerrno = TPE_INVALIDPARA);
+    if (n <= 0) {
+	n = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	if (n > TP_MAXWORKERS)
+	    n = TP_MAXWORKERS;
+    }
+    if (n <= 0)
+	n = 1;
+
+    shares = (TPshare *)malloc(n * sizeof(TPshare));
+    threads = (pthread_t *)malloc(n * sizeof(pthread_t));
+    if (shares == NULL || threads == NULL) {
+	free(shares);
+	free(threads);
+	return (TPerrno = TPE_NOMEM);
+    }
+    for (i = 0; i < n; i++) {
+	pthread_mutex_init(&shares[i].lock, NULL);
+	shares[i].next = shares[i].end = 0;
+    }
+
+    stopping = 0;
+    generation = 0;
+    nworkers = n;
+    for (i = 1; i < n; i++) {
+	rc = pthread_create(&threads[i], NULL, worker, (void *)(long)i);
+	if (rc != 0) {
+	    nworkers = i;
+	    TP_Shutdown();
+	    /* pthread_create does not set errno, TP_PrintError perrors it */
+	    errno = rc;
+	    return (TPerrno = TPE_UNIX);
+	}
+    }
+    return (TPerrno = TPE_OK);
+}
+
+int TP_NumWorkers(void)
+{
+    return nworkers;
+}
+
+int TP_ParallelFor(int lo, int hi, int morsel, TPfunc func, void *arg)
+{
+    int i, n, chunk;
+
+    if (nworkers == 0)
+	return (TPerrno = TPE_NOTINIT);
+    if (morsel <= 0 || func == NULL)
+	return (TPerrno = TPE_INVALIDPARA);
+    if (hi <= lo)
+	return (TPerrno = TPE_OK);
+
+    pthread_mutex_lock(&joblock);
+
+    /* one contiguous share per worker */
+    n = hi - lo;
+    chunk = n / nworkers + (n % nworkers != 0);
+    for (i = 0; i < nworkers; i++) {
+	shares[i].next = lo + i * chunk < hi ? lo + i * chunk : hi;
+	shares[i].end = shares[i].next + chunk < hi ? shares[i].next + chunk : hi;
+    }
+    jobfunc = func;
+    jobarg = arg;
+    jobmorsel = morsel;
+
+    pthread_mutex_lock(&poollock);
+    active = nworkers - 1;
+    generation++;
+    pthread_cond_broadcast(&workcond);
+    pthread_mutex_unlock(&poollock);
+
+    runjob(0);
+
+    pthread_mutex_lock(&poollock);
+    while (active > 0)
+	pthread_cond_wait(&donecond, &poollock);
+    pthread_mutex_unlock(&poollock);
+
+    pthread_mutex_unlock(&joblock);
+    return (TPerrno = TPE_OK);
+}
+
+void TP_Shutdown(void)
+{
+    int i;
+
+    if (nworkers == 0)
+	return;
+
+    pthread_mutex_lock(&poollock);
+    stopping = 1;
+    pthread_cond_broadcast(&workcond);
+    pthread_mutex_unlock(&poollock);
+
+    for (i = 1; i < nworkers; i++)
+	pthread_join(threads[i], NULL);
+    for (i = 0; i < nworkers; i++)
+	pthread_mutex_destroy(&shares[i].lock);
+    free(shares);
+    free(threads);
+    nworkers = 0;
+}
+
+void TP_PrintError(const char *errString)
+{
+    if (TPerrno == TPE_UNIX)
+	perror(errString);
+    else if (TPerrno <= 0 && -TPerrno < TP_NERRORS)
+	fprintf(stderr, "%s: %s\n", errString, TPerrmsg[-TPerrno]);
+    else
+	fprintf(stderr, "%s: unknown TP error %d\n", errString, TPerrno);
+}
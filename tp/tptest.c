@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tp.h"
+
+#define NITEMS		1000000
+#define MORSEL		1000
+#define NWORKERS	4
+
+/*
+ * per-worker partial results, padded so workers do not share cache lines
+ */
+typedef struct {
+    long	sum;
+    long	items;
+    char	pad[64 - 2 * sizeof(long)];
+} partial;
+
+static partial	partials[NWORKERS];
+static char	visited[NITEMS];
+
+/*
+ * add up the items of [lo, hi) and mark each one visited
+ */
+void sumrange(void *arg, int lo, int hi, int worker)
+{
+    int i;
+
+    for (i = lo; i < hi; i++) {
+	partials[worker].sum += i;
+	partials[worker].items++;
+	visited[i]++;
+    }
+}
+
+/*
+ * like sumrange, but the first tenth of the items is much slower, so
+ * the workers that own them must have their shares stolen
+ */
+void skewrange(void *arg, int lo, int hi, int worker)
+{
+    volatile int spin;
+    int i;
+
+    for (i = lo; i < hi; i++) {
+	if (i < NITEMS / 10)
+	    for (spin = 0; spin < 200; spin++)
+		;
+	partials[worker].sum += i;
+	partials[worker].items++;
+	visited[i]++;
+    }
+}
+
+/*
+ * run one loop over [lo, hi) and check that every item was done once
+ */
+void runloop(const char *name, int lo, int hi, int morsel, TPfunc func)
+{
+    long sum, items, expect;
+    int i, bad;
+
+    memset(partials, 0, sizeof(partials));
+    memset(visited, 0, sizeof(visited));
+
+    if (TP_ParallelFor(lo, hi, morsel, func, NULL) != TPE_OK) {
+	TP_PrintError("TP_ParallelFor");
+	exit(1);
+    }
+
+    sum = items = 0;
+    for (i = 0; i < NWORKERS; i++) {
+	sum += partials[i].sum;
+	items += partials[i].items;
+    }
+    bad = 0;
+    for (i = 0; i < NITEMS; i++)
+	if (visited[i] != (i >= lo && i < hi))
+	    bad++;
+    expect = (hi > lo) ? ((long)lo + hi - 1) * (hi - lo) / 2 : 0;
+
+    printf("%s: [%d, %d) morsel %d: %ld items, sum %ld (expected %ld), "
+	"%d items done other than once\n",
+	name, lo, hi, morsel, items, sum, expect, bad);
+}
+
+int main()
+{
+    if (TP_Init(NWORKERS) != TPE_OK) {
+	TP_PrintError("TP_Init");
+	exit(1);
+    }
+    printf("%d workers\n", TP_NumWorkers());
+
+    runloop("even", 0, NITEMS, MORSEL, sumrange);
+    runloop("skewed", 0, NITEMS, MORSEL, skewrange);
+    runloop("odd bounds", 17, NITEMS - 3, 333, sumrange);
+    runloop("fewer items than workers", 5, 7, MORSEL, sumrange);
+    runloop("empty", 10, 10, MORSEL, sumrange);
+
+    if (TP_ParallelFor(0, 10, 0, sumrange, NULL) != TPE_INVALIDPARA)
+	printf("zero morsel not rejected\n");
+    else
+	printf("zero morsel rejected\n");
+
+    TP_Shutdown();
+    if (TP_ParallelFor(0, 10, 1, sumrange, NULL) != TPE_NOTINIT)
+	printf("loop after TP_Shutdown not rejected\n");
+    else
+	printf("loop after TP_Shutdown rejected\n");
+
+    return 0;
+}